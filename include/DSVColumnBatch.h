@@ -0,0 +1,44 @@
+#ifndef DSVCOLUMNBATCH_H
+#define DSVCOLUMNBATCH_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One column of a batch, the values of every row stored back to back.
+// Row i is DData[DOffsets[i], DOffsets[i + 1]). Dictionary encoded columns
+// leave DData empty and store one code per row in DCodes instead, row i is
+// (*DDictionary)[DCodes[i]].
+struct SDSVColumn{
+    std::vector<char> DData;
+    std::vector<std::size_t> DOffsets = {0};
+    std::vector<std::uint32_t> DCodes;
+    const std::vector<std::string> *DDictionary = nullptr;
+
+    std::string_view Value(std::size_t row) const{
+        if(DDictionary){
+            return (*DDictionary)[DCodes[row]];
+        }
+        return std::string_view(DData.data() + DOffsets[row], DOffsets[row + 1] - DOffsets[row]);
+    };
+};
+
+// Rows read by CDSVReader::ReadRows stored column by column. Clearing keeps
+// every buffer's capacity, so a batch reused across reads stops allocating
+// once it has grown to fit.
+struct SDSVColumnBatch{
+    std::vector<SDSVColumn> DColumns;
+    std::size_t DRowCount = 0;
+
+    void Clear(){
+        for(auto &Column : DColumns){
+            Column.DData.clear();
+            Column.DOffsets.resize(1);
+            Column.DCodes.clear();
+        }
+        DRowCount = 0;
+    };
+};
+
+#endif
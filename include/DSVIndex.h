@@ -0,0 +1,37 @@
+#ifndef DSVINDEX_H
+#define DSVINDEX_H
+
+#include <memory>
+#include <vector>
+#include "DataSink.h"
+#include "DataSource.h"
+
+class CDSVReader;
+
+// Byte offsets of every Stride()th row of a DSV input, so a reader can jump
+// near any row with CDSVReader::SeekRow and skip the few rows in between.
+// Saved indexes are a small sidecar of delta-encoded varints.
+class CDSVIndex{
+    private:
+        std::size_t DStride;
+        std::size_t DRowCount;
+        std::vector<std::size_t> DOffsets;
+
+    public:
+        static constexpr std::size_t DefaultStride = 1024;
+
+        CDSVIndex(std::size_t stride = DefaultStride);
+
+        // indexes the rest of reader's rows, counting its next row as row 0
+        void Build(CDSVReader &reader);
+
+        std::size_t Stride() const noexcept;
+        std::size_t RowCount() const noexcept;
+        // finds the closest indexed row at or before row and its offset
+        bool Lookup(std::size_t row, std::size_t &indexedrow, std::size_t &offset) const noexcept;
+
+        bool Save(std::shared_ptr<CDataSink> sink) const;
+        bool Load(std::shared_ptr<CDataSource> src);
+};
+
+#endif
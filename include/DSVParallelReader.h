@@ -0,0 +1,40 @@
+#ifndef DSVPARALLELREADER_H
+#define DSVPARALLELREADER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DataSource.h"
+#include "MmapDataSource.h"
+
+// Parses an in-memory DSV input on several threads. The input is cut into
+// chunks at row boundaries (found with a quote parity pre-pass, so quoted
+// newlines never split a row), and each chunk is parsed with the same rules
+// as CDSVReader. Rows come back in input order, or chunk by chunk in
+// whatever order the chunks finish when ordered is false.
+class CDSVParallelReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        using TRows = std::vector< std::vector<std::string> >;
+
+        static constexpr std::size_t DefaultChunkSize = 1024 * 1024;
+
+        // borrows input, the caller must keep it alive
+        CDSVParallelReader(std::string_view input, char delimiter, bool ordered = true, std::size_t threads = 0, std::size_t chunksize = DefaultChunkSize);
+        // parses the unread part of the mapping in place
+        CDSVParallelReader(std::shared_ptr< CMmapDataSource > src, char delimiter, bool ordered = true, std::size_t threads = 0, std::size_t chunksize = DefaultChunkSize);
+        // reads the rest of src into memory first
+        CDSVParallelReader(std::shared_ptr< CDataSource > src, char delimiter, bool ordered = true, std::size_t threads = 0, std::size_t chunksize = DefaultChunkSize);
+        ~CDSVParallelReader();
+
+        bool End() const;
+        bool ReadRow(std::vector<std::string> &row);
+        // hands out the rows of the next finished chunk in one go
+        bool ReadBatch(TRows &rows);
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef DSVPARALLELWRITER_H
+#define DSVPARALLELWRITER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataSink.h"
+
+// Formats batches of rows on several threads with the same rules as
+// CDSVWriter and writes them to the sink strictly in the order they were
+// submitted. At most maxinflight batches are held at once, WriteBatch waits
+// for the sink to catch up beyond that.
+class CDSVParallelWriter{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        using TRows = std::vector< std::vector<std::string> >;
+
+        // threads of 0 uses the hardware concurrency, maxinflight of 0
+        // allows two batches per thread
+        CDSVParallelWriter(std::shared_ptr< CDataSink > sink, char delimiter, bool quoteall = false, std::size_t threads = 0, std::size_t maxinflight = 0);
+        ~CDSVParallelWriter();
+
+        // queues the rows to be written, false once the sink has failed
+        bool WriteBatch(TRows rows);
+        // waits until every queued batch is written
+        bool Flush();
+};
+
+#endif
@@ -3,7 +3,13 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include "DataSource.h"
+#include "DSVColumnBatch.h"
+#include "DSVSchema.h"
+
+class CDSVIndex;
 
 class CDSVReader{
     private:
@@ -14,8 +20,40 @@ class CDSVReader{
         CDSVReader(std::shared_ptr< CDataSource > src, char delimiter);
         ~CDSVReader();
 
+        // only return these columns, in this order; empty returns all. False
+        // and the selection is unchanged if a column is listed twice or is
+        // INT_MAX or larger
+        bool SelectColumns(const std::vector<std::size_t> &columns);
+        // reads the header row and selects the named columns
+        bool SelectHeaderColumns(const std::vector<std::string> &names);
+        // ReadRows returns these columns of the returned rows as codes into
+        // a dictionary kept by the reader; replaces any earlier dictionaries
+        void EncodeColumns(const std::vector<std::size_t> &columns);
+        // the distinct values seen so far in an encoded column, by code
+        const std::vector<std::string> &Dictionary(std::size_t column) const;
+
         bool End() const;
         bool ReadRow(std::vector<std::string> &row);
+        // moves past the next row without returning it
+        bool SkipRow();
+
+        // source byte offset of the next unread row, assuming the source
+        // was at its start when the reader was created
+        std::size_t Tell() const;
+        // continue reading at a byte offset that starts a row, such as one
+        // returned by Tell; false if the source can't seek
+        bool SeekOffset(std::size_t offset);
+        // continue reading at a zero-based row found through index
+        bool SeekRow(const CDSVIndex &index, std::size_t row);
+        // fields stay valid until the next read from this reader
+        bool ReadRowView(std::vector<std::string_view> &row);
+        // replaces batch with up to maxrows rows, returns how many were read
+        std::size_t ReadRows(SDSVColumnBatch &batch, std::size_t maxrows);
+        // same as ReadRows but converts each column to its schema type
+        std::size_t ReadTypedRows(const TDSVSchema &schema, SDSVTypedBatch &batch, std::size_t maxrows);
+        // guesses column types from up to samplerows buffered rows without
+        // consuming them
+        TDSVSchema InferSchema(std::size_t samplerows = 100);
 };
 
 #endif
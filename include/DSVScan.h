@@ -0,0 +1,16 @@
+#ifndef DSVSCAN_H
+#define DSVSCAN_H
+
+namespace DSVScan{
+
+// Returns the first delimiter, quote or newline in [begin, end), or end if
+// there is none. Scans 16 bytes at a time with SSE2 (32 with AVX2 when the
+// CPU supports it) and falls back to a byte loop on other targets.
+const char *FindSpecial(const char *begin, const char *end, char delimiter) noexcept;
+
+// Returns the first quote in [begin, end), or end if there is none
+const char *FindQuote(const char *begin, const char *end) noexcept;
+
+}
+
+#endif
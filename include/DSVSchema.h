@@ -0,0 +1,67 @@
+#ifndef DSVSCHEMA_H
+#define DSVSCHEMA_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "DSVColumnBatch.h"
+
+enum class EDSVType{Int64, Double, Bool, String, Date};
+
+using TDSVSchema = std::vector< EDSVType >;
+
+// Values of one column read by CDSVReader::ReadTypedRows. Only the storage
+// matching DType is filled: DInts for Int64 and Date (days since
+// 1970-01-01), DDoubles, DBools or DStrings. DValid is 0 for rows whose
+// value was empty, missing or failed to convert; their slot holds 0.
+struct SDSVTypedColumn{
+    EDSVType DType = EDSVType::String;
+    std::vector<std::int64_t> DInts;
+    std::vector<double> DDoubles;
+    std::vector<std::uint8_t> DBools;
+    SDSVColumn DStrings;
+    std::vector<std::uint8_t> DValid;
+};
+
+struct SDSVConversionError{
+    std::size_t DRow;
+    std::size_t DColumn;
+};
+
+struct SDSVTypedBatch{
+    std::vector<SDSVTypedColumn> DColumns;
+    std::vector<SDSVConversionError> DErrors;
+    std::size_t DRowCount = 0;
+
+    void Clear(){
+        for(auto &Column : DColumns){
+            Column.DInts.clear();
+            Column.DDoubles.clear();
+            Column.DBools.clear();
+            Column.DStrings.DData.clear();
+            Column.DStrings.DOffsets.resize(1);
+            Column.DValid.clear();
+        }
+        DErrors.clear();
+        DRowCount = 0;
+    };
+};
+
+namespace DSVSchema{
+
+// Each parser only succeeds if the whole string is consumed
+bool ParseInt64(std::string_view str, std::int64_t &value) noexcept;
+// finite values only, nan and inf are rejected
+bool ParseDouble(std::string_view str, double &value) noexcept;
+// true/false in any case, or 1/0
+bool ParseBool(std::string_view str, bool &value) noexcept;
+// YYYY-MM-DD, converted to days since 1970-01-01
+bool ParseDate(std::string_view str, std::int64_t &days) noexcept;
+
+// Narrowest type a non-empty value parses as, checked in the order Bool
+// (words only), Int64, Double, Date, String
+EDSVType DetectType(std::string_view str) noexcept;
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef DSVTRANSFORM_H
+#define DSVTRANSFORM_H
+
+#include <string>
+#include <vector>
+#include "DSVReader.h"
+#include "DSVWriter.h"
+
+// Row filters and projections used by dsvtool
+namespace DSVTransform{
+
+using TRow = std::vector<std::string>;
+
+enum class EFilterOp{Equal, NotEqual, Contains};
+
+struct SFilter{
+    std::string DColumnName;
+    std::size_t DColumn = 0;
+    EFilterOp DOp = EFilterOp::Equal;
+    std::string DValue;
+
+    // a column the row doesn't have compares as an empty field
+    bool Matches(const TRow &row) const;
+};
+
+// a single character other than quote and newline, or "tab"/"\t"
+bool ParseDelimiter(const std::string &arg, char &delimiter);
+// column=value, column!=value or column~substring; the column is left
+// unresolved in DColumnName
+bool ParseFilter(const std::string &arg, SFilter &filter);
+// a header name if there is a header with that name, otherwise an index
+bool ResolveColumn(const std::string &name, const TRow &header, std::size_t &column);
+// moves the given columns of row into out, in order; columns the row
+// doesn't have become empty fields and a column may be listed twice
+void Project(TRow &row, const std::vector<std::size_t> &columns, TRow &out);
+// Reads the header row if hasheader is set, resolves names into columns and
+// the filters' columns against it and writes it, projected, to writer. With
+// no header row only indices resolve and nothing is written. False with the
+// offending name in unknown if a column doesn't resolve.
+bool StartHeader(CDSVReader &reader, CDSVWriter &writer, bool hasheader, const std::vector<std::string> &names, std::vector<std::size_t> &columns, std::vector<SFilter> &filters, std::string &unknown);
+
+}
+
+#endif
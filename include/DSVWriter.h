@@ -2,7 +2,11 @@
 #define DSVWRITER_H
 
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 #include "DataSink.h"
 
 class CDSVWriter{
@@ -10,11 +14,70 @@ class CDSVWriter{
         struct SImplementation;
         std::unique_ptr<SImplementation> DImplementation;
 
+        bool WriteViews(std::span<const std::string_view> row);
+        void WriteText(std::string_view field);
+        void WriteSigned(long long value);
+        void WriteUnsigned(unsigned long long value);
+        void WriteFloat(float value);
+        void WriteDouble(double value);
+
     public:
-        CDSVWriter(std::shared_ptr< CDataSink > sink, char delimiter, bool quoteall = false);
+        // rows are passed to the sink once flushsize bytes are buffered, the
+        // default of 0 writes every row as soon as it's complete
+        CDSVWriter(std::shared_ptr< CDataSink > sink, char delimiter, bool quoteall = false, std::size_t flushsize = 0);
         ~CDSVWriter();
 
         bool WriteRow(const std::vector<std::string> &row);
+        // any contiguous run of views (vector, array, span); a template so
+        // WriteRow({...}) still picks the vector<string> overload
+        template <typename TRow>
+            requires std::is_convertible_v<const TRow &, std::span<const std::string_view>>
+        bool WriteRow(const TRow &row){
+            return WriteViews(row);
+        }
+
+        // Adds one field to the current row. Numbers are formatted with
+        // std::to_chars straight into the output, bools as true/false and
+        // anything else is taken as text.
+        template <typename TValue>
+        void WriteField(const TValue &value){
+            if constexpr(std::is_same_v<TValue, bool>){
+                WriteText(value ? "true" : "false");
+            }
+            else if constexpr(std::is_same_v<TValue, char>){
+                WriteText(std::string_view(&value, 1));
+            }
+            else if constexpr(std::is_integral_v<TValue> && std::is_signed_v<TValue>){
+                WriteSigned(value);
+            }
+            else if constexpr(std::is_integral_v<TValue>){
+                WriteUnsigned(value);
+            }
+            else if constexpr(std::is_same_v<TValue, float>){
+                // shortest float text, widening first would add digits
+                WriteFloat(value);
+            }
+            else if constexpr(std::is_floating_point_v<TValue>){
+                WriteDouble(value);
+            }
+            else{
+                WriteText(std::string_view(value));
+            }
+        }
+        // finishes the row started by WriteField
+        bool EndRow();
+
+        // writes each value as a field of one row
+        template <typename... TValues>
+        bool WriteValues(const TValues &...values){
+            (WriteField(values), ...);
+            return EndRow();
+        }
+
+        // writes any buffered rows to the sink
+        bool Flush();
+        // moves the buffered rows out instead of writing them to the sink
+        std::string TakeBuffered();
 };
 
 #endif
@@ -1,6 +1,8 @@
 #ifndef DATASINK_H
 #define DATASINK_H
 
+#include <cstddef>
+#include <string_view>
 #include <vector>
 
 class CDataSink{
@@ -8,6 +10,21 @@ class CDataSink{
         virtual ~CDataSink(){};
         virtual bool Put(const char &ch) noexcept = 0;
         virtual bool Write(const std::vector<char> &buf) noexcept = 0;
+
+        // Writes length bytes starting at data in one call. Sinks that don't
+        // override it fall back to one Put per byte.
+        virtual bool Write(const char *data, std::size_t length) noexcept{
+            for(std::size_t Index = 0; Index < length; Index++){
+                if(!Put(data[Index])){
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        bool Write(std::string_view str) noexcept{
+            return Write(str.data(), str.size());
+        };
 };
 
 #endif
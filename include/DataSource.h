@@ -1,15 +1,61 @@
 #ifndef DATASOURCE_H
 #define DATASOURCE_H
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
 class CDataSource{
+    private:
+        // bytes read by the default Window that haven't been consumed yet
+        std::vector<char> DWindowBuffer;
+        std::size_t DWindowIndex = 0;
+
     public:
         virtual ~CDataSource(){};
         virtual bool End() const noexcept = 0;
         virtual bool Get(char &ch) noexcept = 0;
         virtual bool Peek(char &ch) noexcept = 0;
         virtual bool Read(std::vector<char> &buf, std::size_t count) noexcept = 0;
+
+        static constexpr std::size_t DefaultWindowSize = 64 * 1024;
+
+        // Borrows the next contiguous run of unread bytes without consuming
+        // them. The span is only valid until the next call on the source.
+        // Sources that can't expose their storage Read a block into a buffer
+        // here instead; End/Get/Peek/Read of such a source don't see bytes
+        // held there, so read it only through Window and Consume.
+        virtual bool Window(const char *&data, std::size_t &length) noexcept{
+            if(DWindowIndex >= DWindowBuffer.size()){
+                DWindowIndex = 0;
+                if(!Read(DWindowBuffer, DefaultWindowSize)){
+                    DWindowBuffer.clear();
+                    data = nullptr;
+                    length = 0;
+                    return false;
+                }
+            }
+            data = DWindowBuffer.data() + DWindowIndex;
+            length = DWindowBuffer.size() - DWindowIndex;
+            return true;
+        };
+
+        // Advances past count bytes, returns how many were actually skipped
+        virtual std::size_t Consume(std::size_t count) noexcept{
+            std::size_t Consumed = std::min(count, DWindowBuffer.size() - DWindowIndex);
+            DWindowIndex += Consumed;
+            std::vector<char> Discard;
+            while(Consumed < count && Read(Discard, count - Consumed)){
+                Consumed += Discard.size();
+            }
+            return Consumed;
+        };
+
+        // Moves to an absolute byte offset from the start of the input.
+        // Returns false, leaving the position alone, if the source can't seek.
+        virtual bool Seek(std::size_t) noexcept{
+            return false;
+        };
 };
 
 #endif
@@ -0,0 +1,38 @@
+#ifndef FILEDATASINK_H
+#define FILEDATASINK_H
+
+#include "DataSink.h"
+#include <string>
+
+// Buffered sink writing to a POSIX file descriptor (file, pipe, stdout).
+// Output is collected and handed to write() in large blocks; Flush pushes
+// out whatever is pending and the destructor flushes automatically.
+class CFileDataSink : public CDataSink{
+    private:
+        int DFileDescriptor;
+        bool DOwned;
+        std::vector<char> DBuffer;
+        std::size_t DLength;
+
+        bool WriteAll(const char *data, std::size_t length) noexcept;
+    public:
+        static constexpr std::size_t DefaultBufferSize = 256 * 1024;
+
+        // borrows fd, the caller stays responsible for closing it
+        CFileDataSink(int fd, std::size_t bufsize = DefaultBufferSize);
+        CFileDataSink(const std::string &filename, std::size_t bufsize = DefaultBufferSize);
+        ~CFileDataSink();
+
+        CFileDataSink(const CFileDataSink &) = delete;
+        CFileDataSink &operator=(const CFileDataSink &) = delete;
+
+        bool IsOpen() const noexcept;
+        bool Flush() noexcept;
+
+        using CDataSink::Write;
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+        bool Write(const char *data, std::size_t length) noexcept override;
+};
+
+#endif
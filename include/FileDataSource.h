@@ -0,0 +1,42 @@
+#ifndef FILEDATASOURCE_H
+#define FILEDATASOURCE_H
+
+#include "DataSource.h"
+#include <string>
+
+// Buffered source reading from a POSIX file descriptor (file, pipe, stdin).
+// Input is pulled in with large read() calls so unbounded streams can be
+// parsed in constant memory.
+class CFileDataSource : public CDataSource{
+    private:
+        int DFileDescriptor;
+        bool DOwned;
+        mutable std::vector<char> DBuffer;
+        mutable std::size_t DIndex;
+        mutable std::size_t DLength;
+        mutable bool DEOF;
+
+        bool Fill() const noexcept;
+    public:
+        static constexpr std::size_t DefaultBufferSize = 256 * 1024;
+
+        // borrows fd, the caller stays responsible for closing it
+        CFileDataSource(int fd, std::size_t bufsize = DefaultBufferSize);
+        CFileDataSource(const std::string &filename, std::size_t bufsize = DefaultBufferSize);
+        ~CFileDataSource();
+
+        CFileDataSource(const CFileDataSource &) = delete;
+        CFileDataSource &operator=(const CFileDataSource &) = delete;
+
+        bool IsOpen() const noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        bool Window(const char *&data, std::size_t &length) noexcept override;
+        std::size_t Consume(std::size_t count) noexcept override;
+        bool Seek(std::size_t offset) noexcept override;
+};
+
+#endif
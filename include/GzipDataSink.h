@@ -0,0 +1,44 @@
+#ifndef GZIPDATASINK_H
+#define GZIPDATASINK_H
+
+#include "DataSink.h"
+#include <climits>
+#include <memory>
+#include <zlib.h>
+
+// Compresses everything written to it into gzip format and passes the
+// compressed blocks on to another sink. Finish writes the gzip trailer and
+// is called by the destructor if it wasn't called explicitly.
+class CGzipDataSink : public CDataSink{
+    private:
+        std::shared_ptr< CDataSink > DSink;
+        z_stream DStream;
+        std::vector<char> DInput;
+        std::vector<char> DOutput;
+        bool DFinished;
+        bool DError;
+        std::size_t DMaxSlice;
+
+        bool Deflate(const char *data, std::size_t length, int flush) noexcept;
+    public:
+        static constexpr std::size_t DefaultBufferSize = 256 * 1024;
+
+        // zlib counts input in a 32-bit uInt, so longer writes are handed to
+        // it maxslice bytes at a time
+        CGzipDataSink(std::shared_ptr< CDataSink > sink, int level = Z_DEFAULT_COMPRESSION, std::size_t bufsize = DefaultBufferSize, std::size_t maxslice = UINT_MAX);
+        ~CGzipDataSink();
+
+        CGzipDataSink(const CGzipDataSink &) = delete;
+        CGzipDataSink &operator=(const CGzipDataSink &) = delete;
+
+        // pushes all pending data through to the sink without ending the stream
+        bool Flush() noexcept;
+        bool Finish() noexcept;
+
+        using CDataSink::Write;
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+        bool Write(const char *data, std::size_t length) noexcept override;
+};
+
+#endif
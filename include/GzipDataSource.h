@@ -0,0 +1,40 @@
+#ifndef GZIPDATASOURCE_H
+#define GZIPDATASOURCE_H
+
+#include "DataSource.h"
+#include <memory>
+#include <zlib.h>
+
+// Decompresses a gzip (or zlib) stream read from another source on the fly,
+// so compressed files can be handed straight to the readers.
+class CGzipDataSource : public CDataSource{
+    private:
+        std::shared_ptr< CDataSource > DSource;
+        mutable z_stream DStream;
+        mutable std::vector<char> DBuffer;
+        mutable std::size_t DIndex;
+        mutable std::size_t DLength;
+        mutable bool DDone;
+
+        bool Fill() const noexcept;
+    public:
+        static constexpr std::size_t DefaultBufferSize = 256 * 1024;
+
+        CGzipDataSource(std::shared_ptr< CDataSource > src, std::size_t bufsize = DefaultBufferSize);
+        ~CGzipDataSource();
+
+        CGzipDataSource(const CGzipDataSource &) = delete;
+        CGzipDataSource &operator=(const CGzipDataSource &) = delete;
+
+        // true if the compressed input was corrupt or truncated
+        bool Error() const noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        bool Window(const char *&data, std::size_t &length) noexcept override;
+        std::size_t Consume(std::size_t count) noexcept override;
+};
+
+#endif
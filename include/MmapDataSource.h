@@ -0,0 +1,36 @@
+#ifndef MMAPDATASOURCE_H
+#define MMAPDATASOURCE_H
+
+#include "DataSource.h"
+#include <string>
+
+// Read-only memory-mapped file source. The mapped bytes can be scanned
+// directly through Data()/Size() without copying them into a string first.
+class CMmapDataSource : public CDataSource{
+    private:
+        const char *DData;
+        std::size_t DSize;
+        std::size_t DIndex;
+        bool DOpen;
+    public:
+        CMmapDataSource(const std::string &filename);
+        ~CMmapDataSource();
+
+        CMmapDataSource(const CMmapDataSource &) = delete;
+        CMmapDataSource &operator=(const CMmapDataSource &) = delete;
+
+        bool IsOpen() const noexcept;
+        const char *Data() const noexcept;
+        std::size_t Size() const noexcept;
+        std::size_t Position() const noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        bool Window(const char *&data, std::size_t &length) noexcept override;
+        std::size_t Consume(std::size_t count) noexcept override;
+        bool Seek(std::size_t offset) noexcept override;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef PREFETCHDATASOURCE_H
+#define PREFETCHDATASOURCE_H
+
+#include "DataSource.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Wraps another source and reads ahead of the parser on a background
+// thread, filling a ring of queuedepth buffers of bufsize bytes each. The
+// wrapped source must not be used by anyone else while this is alive.
+class CPrefetchDataSource : public CDataSource{
+    private:
+        std::shared_ptr< CDataSource > DSource;
+        std::vector< std::vector<char> > DBuffers;
+        std::size_t DBufferSize;
+        // slot DHead is the one being consumed, DFilled counts it too
+        mutable std::size_t DHead;
+        mutable std::size_t DFilled;
+        mutable std::size_t DIndex;
+        mutable bool DHolding;
+        bool DSourceDone;
+        bool DStop;
+        mutable std::mutex DMutex;
+        mutable std::condition_variable DFilledCondition;
+        mutable std::condition_variable DFreeCondition;
+        std::thread DThread;
+
+        void Prefetch();
+        bool Fill() const noexcept;
+    public:
+        static constexpr std::size_t DefaultBufferSize = 256 * 1024;
+        static constexpr std::size_t DefaultQueueDepth = 4;
+
+        CPrefetchDataSource(std::shared_ptr< CDataSource > src, std::size_t bufsize = DefaultBufferSize, std::size_t queuedepth = DefaultQueueDepth);
+        ~CPrefetchDataSource();
+
+        CPrefetchDataSource(const CPrefetchDataSource &) = delete;
+        CPrefetchDataSource &operator=(const CPrefetchDataSource &) = delete;
+
+        std::size_t BufferSize() const noexcept;
+        std::size_t QueueDepth() const noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        bool Window(const char *&data, std::size_t &length) noexcept override;
+        std::size_t Consume(std::size_t count) noexcept override;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free queue between exactly one producer thread and one
+// consumer thread. Head and tail only ever grow and are masked into a power
+// of two ring, each side only writes its own counter.
+template <typename TItem>
+class CSPSCQueue{
+    private:
+        // failed tries before a blocking call sleeps on the other side's
+        // counter instead of spinning
+        static constexpr int SpinCount = 64;
+
+        std::vector<TItem> DSlots;
+        std::size_t DMask;
+        // next slot to pop, only written by the consumer
+        alignas(64) std::atomic<std::size_t> DHead{0};
+        // next slot to push, only written by the producer
+        alignas(64) std::atomic<std::size_t> DTail{0};
+
+    public:
+        explicit CSPSCQueue(std::size_t capacity){
+            std::size_t Size = 1;
+            while(Size < capacity){
+                Size <<= 1;
+            }
+            DSlots.resize(Size);
+            DMask = Size - 1;
+        }
+
+        CSPSCQueue(const CSPSCQueue &) = delete;
+        CSPSCQueue &operator=(const CSPSCQueue &) = delete;
+
+        std::size_t Capacity() const noexcept{
+            return DSlots.size();
+        }
+
+        // moves item in unless the queue is full
+        bool TryPush(TItem &item){
+            std::size_t Tail = DTail.load(std::memory_order_relaxed);
+            if(Tail - DHead.load(std::memory_order_acquire) == DSlots.size()){
+                return false;
+            }
+            DSlots[Tail & DMask] = std::move(item);
+            DTail.store(Tail + 1, std::memory_order_release);
+            DTail.notify_one();
+            return true;
+        }
+
+        // moves the oldest item out unless the queue is empty
+        bool TryPop(TItem &item){
+            std::size_t Head = DHead.load(std::memory_order_relaxed);
+            if(Head == DTail.load(std::memory_order_acquire)){
+                return false;
+            }
+            item = std::move(DSlots[Head & DMask]);
+            DHead.store(Head + 1, std::memory_order_release);
+            DHead.notify_one();
+            return true;
+        }
+
+        // blocking versions spin briefly, then sleep until the other side
+        // moves its counter
+        void Push(TItem item){
+            for(int Spin = 0; !TryPush(item); Spin++){
+                if(Spin < SpinCount){
+                    std::this_thread::yield();
+                    continue;
+                }
+                // full means head is exactly one lap behind our tail
+                DHead.wait(DTail.load(std::memory_order_relaxed) - DSlots.size(), std::memory_order_acquire);
+            }
+        }
+
+        void Pop(TItem &item){
+            for(int Spin = 0; !TryPop(item); Spin++){
+                if(Spin < SpinCount){
+                    std::this_thread::yield();
+                    continue;
+                }
+                // empty means tail equals our head
+                DTail.wait(DHead.load(std::memory_order_relaxed), std::memory_order_acquire);
+            }
+        }
+};
+
+#endif
@@ -9,9 +9,14 @@ class CStringDataSink : public CDataSink{
         std::string DString;
     public:
         const std::string &String() const;
+        void Reserve(std::size_t size);
+        // moves the accumulated output out and leaves the sink empty
+        std::string Take() noexcept;
 
+        using CDataSink::Write;
         bool Put(const char &ch) noexcept override;
         bool Write(const std::vector<char> &buf) noexcept override;
+        bool Write(const char *data, std::size_t length) noexcept override;
 };
 
 #endif
@@ -3,18 +3,32 @@
 
 #include "DataSource.h"
 #include <string>
+#include <string_view>
 
 class CStringDataSource : public CDataSource{
     private:
         std::string DString;
+        // either views DString or borrowed caller memory
+        std::string_view DView;
+        bool DBorrowed;
         size_t DIndex;
     public:
         CStringDataSource(const std::string &str);
+        CStringDataSource(const char *str);
+        CStringDataSource(std::string &&str);
+        // borrows the characters, the caller must keep them alive
+        explicit CStringDataSource(std::string_view str);
+
+        CStringDataSource(const CStringDataSource &source);
+        CStringDataSource &operator=(const CStringDataSource &source) = delete;
 
         bool End() const noexcept override;
         bool Get(char &ch) noexcept override;
         bool Peek(char &ch) noexcept override;
         bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        bool Window(const char *&data, std::size_t &length) noexcept override;
+        std::size_t Consume(std::size_t count) noexcept override;
+        bool Seek(std::size_t offset) noexcept override;
 };
 
 #endif
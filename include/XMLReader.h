@@ -11,11 +11,25 @@ class CXMLReader{
         std::unique_ptr<SImplementation> DImplementation;
         
     public:
-        CXMLReader(std::shared_ptr< CDataSource > src);
+        static constexpr std::size_t DefaultChunkSize = 64 * 1024;
+        static constexpr std::size_t DefaultMaxQueued = 256;
+
+        // input is handed to expat chunksize bytes at a time, parsing pauses
+        // while about maxqueued entities wait to be read
+        CXMLReader(std::shared_ptr< CDataSource > src, std::size_t chunksize = DefaultChunkSize, std::size_t maxqueued = DefaultMaxQueued);
         ~CXMLReader();
+
+        // splits character data into CharData entities of at most limit
+        // bytes (or one character if that is longer), never inside a UTF-8
+        // sequence; 0, the default, returns each run of text whole
+        void SetCharDataLimit(std::size_t limit);
         
         bool End() const;
         bool ReadEntity(SXMLEntity &entity, bool skipcdata = false);
+        // Right after ReadEntity returned a StartElement, discards everything
+        // up to and including its EndElement without building entities.
+        // False if the last entity wasn't a StartElement or input ran out.
+        bool SkipElement();
 };
 
 #endif
@@ -0,0 +1,111 @@
+#include "DSVIndex.h"
+#include "DSVReader.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+namespace{
+    constexpr std::string_view Magic = "DSVI";
+
+    void PutVarint(std::string &out, std::size_t value){
+        while(value >= 0x80){
+            out.push_back(char((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(char(value));
+    }
+
+    bool GetVarint(const std::vector<char> &in, std::size_t &index, std::size_t &value){
+        value = 0;
+        for(unsigned Shift = 0; Shift < 64 && index < in.size(); Shift += 7){
+            unsigned char Byte = in[index++];
+            value |= std::size_t(Byte & 0x7F) << Shift;
+            if(!(Byte & 0x80)){
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+CDSVIndex::CDSVIndex(std::size_t stride) : DStride(std::max<std::size_t>(stride, 1)), DRowCount(0){
+
+}
+
+void CDSVIndex::Build(CDSVReader &reader){
+    DOffsets.clear();
+    DRowCount = 0;
+    while(true){
+        std::size_t Offset = reader.Tell();
+        if(!reader.SkipRow()){
+            break;
+        }
+        if(DRowCount % DStride == 0){
+            DOffsets.push_back(Offset);
+        }
+        DRowCount++;
+    }
+}
+
+std::size_t CDSVIndex::Stride() const noexcept{
+    return DStride;
+}
+
+std::size_t CDSVIndex::RowCount() const noexcept{
+    return DRowCount;
+}
+
+bool CDSVIndex::Lookup(std::size_t row, std::size_t &indexedrow, std::size_t &offset) const noexcept{
+    if(row >= DRowCount){
+        return false;
+    }
+    indexedrow = row - row % DStride;
+    offset = DOffsets[row / DStride];
+    return true;
+}
+
+bool CDSVIndex::Save(std::shared_ptr<CDataSink> sink) const{
+    // offsets only grow, so the gaps between them are short varints
+    std::string Out(Magic);
+    PutVarint(Out, DStride);
+    PutVarint(Out, DRowCount);
+    std::size_t Previous = 0;
+    for(auto Offset : DOffsets){
+        PutVarint(Out, Offset - Previous);
+        Previous = Offset;
+    }
+    return sink->Write(Out);
+}
+
+bool CDSVIndex::Load(std::shared_ptr<CDataSource> src){
+    std::vector<char> In, Chunk;
+    while(src->Read(Chunk, 64 * 1024)){
+        In.insert(In.end(), Chunk.begin(), Chunk.end());
+    }
+    if(In.size() < Magic.size() || std::string_view(In.data(), Magic.size()) != Magic){
+        return false;
+    }
+    std::size_t Index = Magic.size();
+    std::size_t Stride, RowCount;
+    if(!GetVarint(In, Index, Stride) || !GetVarint(In, Index, RowCount) || !Stride){
+        return false;
+    }
+    std::vector<std::size_t> Offsets;
+    std::size_t Offset = 0;
+    while(Index < In.size()){
+        std::size_t Delta;
+        if(!GetVarint(In, Index, Delta)){
+            return false;
+        }
+        Offset += Delta;
+        Offsets.push_back(Offset);
+    }
+    if(Offsets.size() != (RowCount + Stride - 1) / Stride){
+        return false;
+    }
+    DStride = Stride;
+    DRowCount = RowCount;
+    DOffsets = std::move(Offsets);
+    return true;
+}
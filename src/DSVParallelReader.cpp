@@ -0,0 +1,261 @@
+#include "DSVParallelReader.h"
+#include "DSVReader.h"
+#include "StringDataSource.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct CDSVParallelReader::SImplementation {
+    struct SChunk {
+        size_t DBegin = 0;
+        size_t DEnd = 0;
+        TRows DRows;
+        bool DDone = false;
+        bool DDelivered = false;
+    };
+
+    std::shared_ptr<CDataSource> DSource;
+    std::string DOwnedInput;
+    std::string_view DInput;
+    char DDelimiter;
+    bool DOrdered;
+    size_t DThreadCount;
+    size_t DMaxInFlight;
+
+    std::vector<SChunk> DChunks;
+    size_t DNextTask = 0;
+    size_t DNextOrdered = 0;
+    size_t DDeliveredCount = 0;
+    bool DStop = false;
+    mutable std::mutex DMutex;
+    std::condition_variable DTaskCondition;
+    std::condition_variable DDoneCondition;
+    std::vector<std::thread> DWorkers;
+
+    TRows DCurrent;
+    size_t DCurrentIndex = 0;
+
+    // runs work(0..count-1) spread over the thread count and waits for it
+    template <typename TWork>
+    void RunParallel(size_t count, TWork work){
+        std::atomic<size_t> Next{0};
+        auto Worker = [&]{
+            for(size_t Index = Next++; Index < count; Index = Next++){
+                work(Index);
+            }
+        };
+        std::vector<std::thread> Threads;
+        for(size_t Index = 1; Index < std::min(DThreadCount, count); Index++){
+            Threads.emplace_back(Worker);
+        }
+        Worker();
+        for(auto &Thread : Threads){
+            Thread.join();
+        }
+    }
+
+    void Start(size_t threads, size_t chunksize){
+        DThreadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        DMaxInFlight = DThreadCount * 2;
+        chunksize = std::max<size_t>(chunksize, 1);
+        size_t PieceCount = (DInput.size() + chunksize - 1) / chunksize;
+
+        // pass 1: quote parity of every nominal piece
+        std::vector<unsigned char> Parity(PieceCount);
+        RunParallel(PieceCount, [&](size_t piece){
+            size_t Begin = piece * chunksize;
+            size_t End = std::min(DInput.size(), Begin + chunksize);
+            Parity[piece] = std::count(DInput.begin() + Begin, DInput.begin() + End, '"') & 1;
+        });
+
+        // pass 2: each piece's row boundary is the first newline at or after
+        // its nominal start that isn't inside quotes. Every quote toggles the
+        // state, which also covers "" escapes and quotes mid-field. A piece
+        // only scans its own bytes; without a newline there, its boundary is
+        // the next piece's, so a long quoted field is only scanned once.
+        std::vector<unsigned char> InQuotes(PieceCount);
+        for(size_t Piece = 1; Piece < PieceCount; Piece++){
+            InQuotes[Piece] = InQuotes[Piece - 1] ^ Parity[Piece - 1];
+        }
+        std::vector<size_t> Boundaries(PieceCount + 1, DInput.size());
+        std::vector<unsigned char> Found(PieceCount + 1, 1);
+        RunParallel(PieceCount, [&](size_t piece){
+            if(!piece){
+                Boundaries[0] = 0;
+                return;
+            }
+            bool Quoted = InQuotes[piece];
+            size_t End = std::min(DInput.size(), (piece + 1) * chunksize);
+            for(size_t Index = piece * chunksize; Index < End; Index++){
+                if(DInput[Index] == '"'){
+                    Quoted = !Quoted;
+                }
+                else if(DInput[Index] == '\n' && !Quoted){
+                    // boundary sits right after a row's newline
+                    Boundaries[piece] = Index + 1;
+                    return;
+                }
+            }
+            Found[piece] = 0;
+        });
+        for(size_t Piece = PieceCount; Piece-- > 1;){
+            if(!Found[Piece]){
+                Boundaries[Piece] = Boundaries[Piece + 1];
+            }
+        }
+
+        // boundaries never decrease, pieces swallowed by a long row just
+        // leave empty chunks which are dropped so End() can be exact
+        for(size_t Piece = 0; Piece < PieceCount; Piece++){
+            if(Boundaries[Piece] < Boundaries[Piece + 1]){
+                SChunk Chunk;
+                Chunk.DBegin = Boundaries[Piece];
+                Chunk.DEnd = Boundaries[Piece + 1];
+                DChunks.push_back(std::move(Chunk));
+            }
+        }
+
+        for(size_t Index = 0; Index < std::min(DThreadCount, DChunks.size()); Index++){
+            DWorkers.emplace_back(&SImplementation::Work, this);
+        }
+    }
+
+    void Work(){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        while(true){
+            // cap how far workers run ahead of the consumer
+            DTaskCondition.wait(Lock, [this]{
+                return DStop || DNextTask >= DChunks.size() || DNextTask < DDeliveredCount + DMaxInFlight;
+            });
+            if(DStop || DNextTask >= DChunks.size()){
+                return;
+            }
+            SChunk &Chunk = DChunks[DNextTask++];
+            Lock.unlock();
+
+            TRows Rows;
+            auto Source = std::make_shared<CStringDataSource>(DInput.substr(Chunk.DBegin, Chunk.DEnd - Chunk.DBegin));
+            CDSVReader Reader(Source, DDelimiter);
+            std::vector<std::string> Row;
+            while(Reader.ReadRow(Row)){
+                Rows.push_back(std::move(Row));
+            }
+
+            Lock.lock();
+            Chunk.DRows = std::move(Rows);
+            Chunk.DDone = true;
+            DDoneCondition.notify_all();
+        }
+    }
+
+    bool NextBatch(TRows &rows){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        if(DDeliveredCount >= DChunks.size()){
+            return false;
+        }
+        SChunk *Chunk = nullptr;
+        DDoneCondition.wait(Lock, [&]{
+            if(DOrdered){
+                Chunk = DChunks[DNextOrdered].DDone ? &DChunks[DNextOrdered] : nullptr;
+                return Chunk != nullptr;
+            }
+            for(size_t Index = DNextOrdered; Index < DNextTask; Index++){
+                if(DChunks[Index].DDone && !DChunks[Index].DDelivered){
+                    Chunk = &DChunks[Index];
+                    return true;
+                }
+            }
+            return false;
+        });
+        rows = std::move(Chunk->DRows);
+        Chunk->DRows = TRows();
+        Chunk->DDelivered = true;
+        DDeliveredCount++;
+        while(DNextOrdered < DChunks.size() && DChunks[DNextOrdered].DDelivered){
+            DNextOrdered++;
+        }
+        DTaskCondition.notify_all();
+        return true;
+    }
+
+    ~SImplementation(){
+        {
+            std::lock_guard<std::mutex> Lock(DMutex);
+            DStop = true;
+        }
+        DTaskCondition.notify_all();
+        for(auto &Worker : DWorkers){
+            Worker.join();
+        }
+    }
+};
+
+CDSVParallelReader::CDSVParallelReader(std::string_view input, char delimiter, bool ordered, std::size_t threads, std::size_t chunksize)
+    : DImplementation(std::make_unique<SImplementation>()) {
+    DImplementation->DInput = input;
+    // quote char can't be a delimiter, fall back to comma
+    DImplementation->DDelimiter = (delimiter == '"') ? ',' : delimiter;
+    DImplementation->DOrdered = ordered;
+    DImplementation->Start(threads, chunksize);
+}
+
+CDSVParallelReader::CDSVParallelReader(std::shared_ptr<CMmapDataSource> src, char delimiter, bool ordered, std::size_t threads, std::size_t chunksize)
+    : CDSVParallelReader(std::string_view(src->Data() + src->Position(), src->Size() - src->Position()), delimiter, ordered, threads, chunksize) {
+    // holding on to the source keeps the mapping alive
+    DImplementation->DSource = src;
+}
+
+CDSVParallelReader::CDSVParallelReader(std::shared_ptr<CDataSource> src, char delimiter, bool ordered, std::size_t threads, std::size_t chunksize)
+    : DImplementation(std::make_unique<SImplementation>()) {
+    const char *Data;
+    std::size_t Length;
+    while(src->Window(Data, Length)){
+        DImplementation->DOwnedInput.append(Data, Length);
+        src->Consume(Length);
+    }
+    DImplementation->DInput = DImplementation->DOwnedInput;
+    DImplementation->DDelimiter = (delimiter == '"') ? ',' : delimiter;
+    DImplementation->DOrdered = ordered;
+    DImplementation->Start(threads, chunksize);
+}
+
+CDSVParallelReader::~CDSVParallelReader() = default;
+
+bool CDSVParallelReader::End() const {
+    std::lock_guard<std::mutex> Lock(DImplementation->DMutex);
+    return DImplementation->DCurrentIndex >= DImplementation->DCurrent.size()
+        && DImplementation->DDeliveredCount >= DImplementation->DChunks.size();
+}
+
+bool CDSVParallelReader::ReadRow(std::vector<std::string> &row) {
+    auto &Impl = *DImplementation;
+    if(Impl.DCurrentIndex >= Impl.DCurrent.size()){
+        Impl.DCurrentIndex = 0;
+        if(!Impl.NextBatch(Impl.DCurrent)){
+            Impl.DCurrent.clear();
+            row.clear();
+            return false;
+        }
+    }
+    row = std::move(Impl.DCurrent[Impl.DCurrentIndex++]);
+    return true;
+}
+
+bool CDSVParallelReader::ReadBatch(TRows &rows) {
+    auto &Impl = *DImplementation;
+    // rows left over from ReadRow go first
+    if(Impl.DCurrentIndex < Impl.DCurrent.size()){
+        rows.assign(std::make_move_iterator(Impl.DCurrent.begin() + Impl.DCurrentIndex), std::make_move_iterator(Impl.DCurrent.end()));
+        Impl.DCurrent.clear();
+        Impl.DCurrentIndex = 0;
+        return true;
+    }
+    if(!Impl.NextBatch(rows)){
+        rows.clear();
+        return false;
+    }
+    return true;
+}
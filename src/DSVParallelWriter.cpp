@@ -0,0 +1,154 @@
+#include "DSVParallelWriter.h"
+#include "DSVWriter.h"
+#include "StringDataSink.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+struct CDSVParallelWriter::SImplementation {
+    struct SBatch {
+        TRows DRows;
+        std::string DText;
+        bool DFormatted = false;
+    };
+
+    std::shared_ptr<CDataSink> DSink;
+    char DDelimiter;
+    bool DQuoteAll;
+    size_t DMaxInFlight;
+
+    // submitted but not yet written, in submission order; references stay
+    // valid while other batches are pushed and popped
+    std::deque<SBatch> DBatches;
+    // sequence number of DBatches.front()
+    size_t DWrittenCount = 0;
+    // sequence number of the next batch to format
+    size_t DNextTask = 0;
+    bool DStop = false;
+    bool DFailed = false;
+    std::mutex DMutex;
+    std::condition_variable DTaskCondition;
+    std::condition_variable DFormattedCondition;
+    std::condition_variable DSpaceCondition;
+    std::vector<std::thread> DWorkers;
+    std::thread DWriter;
+
+    void Start(size_t threads, size_t maxinflight){
+        size_t ThreadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        DMaxInFlight = maxinflight ? maxinflight : ThreadCount * 2;
+        for(size_t Index = 0; Index < ThreadCount; Index++){
+            DWorkers.emplace_back(&SImplementation::Work, this);
+        }
+        DWriter = std::thread(&SImplementation::WriteLoop, this);
+    }
+
+    void Work(){
+        // workers only format, so each writer gets a private sink it never
+        // flushes to; the batch takes the writer's buffer instead
+        CDSVWriter Writer(std::make_shared<CStringDataSink>(), DDelimiter, DQuoteAll, std::numeric_limits<size_t>::max());
+        std::unique_lock<std::mutex> Lock(DMutex);
+        while(true){
+            DTaskCondition.wait(Lock, [this]{
+                return DStop || DNextTask < DWrittenCount + DBatches.size();
+            });
+            if(DNextTask >= DWrittenCount + DBatches.size()){
+                return;
+            }
+            // not formatted yet, so the writer can't pop it while unlocked
+            SBatch &Batch = DBatches[DNextTask++ - DWrittenCount];
+            TRows Rows = std::move(Batch.DRows);
+            Lock.unlock();
+
+            for(auto &Row : Rows){
+                Writer.WriteRow(Row);
+            }
+            std::string Text = Writer.TakeBuffered();
+
+            Lock.lock();
+            Batch.DText = std::move(Text);
+            Batch.DFormatted = true;
+            DFormattedCondition.notify_one();
+        }
+    }
+
+    void WriteLoop(){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        while(true){
+            DFormattedCondition.wait(Lock, [this]{
+                return (!DBatches.empty() && DBatches.front().DFormatted) || (DStop && DBatches.empty());
+            });
+            if(DBatches.empty()){
+                return;
+            }
+            std::string Text = std::move(DBatches.front().DText);
+            // after a failure the rest is dropped so producers don't block
+            bool Skip = DFailed || Text.empty();
+            Lock.unlock();
+            bool Success = Skip || DSink->Write(Text);
+            Lock.lock();
+            DFailed = DFailed || !Success;
+            DBatches.pop_front();
+            DWrittenCount++;
+            DSpaceCondition.notify_all();
+        }
+    }
+
+    bool Submit(TRows &&rows){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        // backpressure, a slow sink holds the producer here
+        DSpaceCondition.wait(Lock, [this]{
+            return DBatches.size() < DMaxInFlight;
+        });
+        if(DFailed){
+            return false;
+        }
+        DBatches.emplace_back().DRows = std::move(rows);
+        DTaskCondition.notify_one();
+        return true;
+    }
+
+    bool Flush(){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        DSpaceCondition.wait(Lock, [this]{
+            return DBatches.empty();
+        });
+        return !DFailed;
+    }
+
+    ~SImplementation(){
+        Flush();
+        {
+            std::lock_guard<std::mutex> Lock(DMutex);
+            DStop = true;
+        }
+        DTaskCondition.notify_all();
+        DFormattedCondition.notify_all();
+        for(auto &Worker : DWorkers){
+            Worker.join();
+        }
+        DWriter.join();
+    }
+};
+
+CDSVParallelWriter::CDSVParallelWriter(std::shared_ptr<CDataSink> sink, char delimiter, bool quoteall, std::size_t threads, std::size_t maxinflight)
+    : DImplementation(std::make_unique<SImplementation>()) {
+    DImplementation->DSink = sink;
+    // quote char can't be a delimiter, fall back to comma
+    DImplementation->DDelimiter = (delimiter == '"') ? ',' : delimiter;
+    DImplementation->DQuoteAll = quoteall;
+    DImplementation->Start(threads, maxinflight);
+}
+
+CDSVParallelWriter::~CDSVParallelWriter() = default;
+
+bool CDSVParallelWriter::WriteBatch(TRows rows) {
+    return DImplementation->Submit(std::move(rows));
+}
+
+bool CDSVParallelWriter::Flush() {
+    return DImplementation->Flush();
+}
@@ -1,9 +1,558 @@
 #include "DSVReader.h"
+#include "DSVIndex.h"
+#include "DSVScan.h"
+#include "DSVSchema.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <unordered_map>
 
 struct CDSVReader::SImplementation {
     std::shared_ptr<CDataSource> DSource;
     char DDelimiter;
     bool DEnd;
+    // whether ScanRow's last row reached its newline, a visitor refusing the
+    // refill that follows doesn't cut that row short
+    bool DRowEnded = false;
+
+    // window borrowed from the source, bytes before DCursor are already parsed
+    // but only handed back to the source when the window runs out
+    const char *DWindowStart = nullptr;
+    const char *DCursor = nullptr;
+    const char *DLimit = nullptr;
+    // source offset of DWindowStart, or of the next byte when there's no window
+    size_t DBase = 0;
+    // InferSchema's copy of input it had to pull past the window; while
+    // DReplaying the window points into it and its bytes are already consumed
+    // from the source
+    std::string DReplay;
+    bool DReplaying = false;
+
+    // ReadRow builds fields here so their capacity is reused between rows
+    std::string DField;
+
+    // column index -> position in the returned row, -1 for skipped columns;
+    // empty means every column is returned in file order
+    std::vector<int> DProjection;
+    size_t DProjectedCount = 0;
+
+    int Slot(size_t column) const{
+        if(DProjection.empty()){
+            return column;
+        }
+        return column < DProjection.size() ? DProjection[column] : -1;
+    }
+
+    // interned values of one encoded column, looked up by view so repeats
+    // don't allocate
+    struct SStringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const{
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+    struct SDictionary {
+        std::vector<std::string> DValues;
+        std::unordered_map<std::string, std::uint32_t, SStringHash, std::equal_to<>> DCodes;
+
+        std::uint32_t Intern(std::string_view value){
+            auto Found = DCodes.find(value);
+            if(Found != DCodes.end()){
+                return Found->second;
+            }
+            std::uint32_t Code = DValues.size();
+            DValues.emplace_back(value);
+            DCodes.emplace(DValues.back(), Code);
+            return Code;
+        }
+    };
+    // position in the returned row -> its dictionary, null when not encoded
+    std::vector<std::unique_ptr<SDictionary>> DDictionaries;
+
+    SDictionary *Dictionary(size_t slot) const{
+        return slot < DDictionaries.size() ? DDictionaries[slot].get() : nullptr;
+    }
+
+    // ReadRowView state, fields either point into the window or into the arena
+    struct SFieldRef {
+        const char *DData;
+        size_t DOffset;
+        size_t DLength;
+        bool DInArena;
+    };
+    std::vector<SFieldRef> DFieldRefs;
+    SFieldRef DCurrentRef;
+    bool DCurrentStarted = false;
+    std::string DArena;
+
+    ~SImplementation(){
+        // leave the source positioned right after the last parsed byte
+        if(DWindowStart && !DReplaying){
+            DSource->Consume(DCursor - DWindowStart);
+        }
+    }
+
+    // make sure there is at least one unparsed byte under the cursor, the
+    // visitor gets a chance to copy out anything still pointing at the window
+    // or to stop at the end of the window by returning false
+    template <typename TVisitor>
+    bool Fill(TVisitor &visitor){
+        if(DCursor < DLimit){
+            return true;
+        }
+        if(!visitor.BeforeRefill()){
+            return false;
+        }
+        if(DWindowStart){
+            if(!DReplaying){
+                DSource->Consume(DCursor - DWindowStart);
+            }
+            DBase += DCursor - DWindowStart;
+            if(DReplaying){
+                DReplaying = false;
+                std::string().swap(DReplay);
+            }
+        }
+        size_t Length;
+        if(!DSource->Window(DWindowStart, Length)){
+            DWindowStart = DCursor = DLimit = nullptr;
+            return false;
+        }
+        DCursor = DWindowStart;
+        DLimit = DWindowStart + Length;
+        return true;
+    }
+
+    // Moves the unparsed rest of the window into DReplay and appends at least
+    // as much again from the source, so a sample can look past the window.
+    // False once the source has nothing more.
+    bool ExtendReplay(){
+        if(DReplaying){
+            DReplay.erase(0, DCursor - DWindowStart);
+        }
+        else{
+            DReplay.assign(DCursor, DLimit);
+            DSource->Consume(DLimit - DWindowStart);
+            DReplaying = true;
+        }
+        DBase += DCursor - DWindowStart;
+        size_t Target = DReplay.size() * 2;
+        bool More = true;
+        do{
+            const char *Data;
+            size_t Length;
+            if(!DSource->Window(Data, Length)){
+                More = false;
+                break;
+            }
+            DReplay.append(Data, Length);
+            DSource->Consume(Length);
+        }while(DReplay.size() < Target);
+        DWindowStart = DCursor = DReplay.data();
+        DLimit = DWindowStart + DReplay.size();
+        return More;
+    }
+
+    // Parses one row and reports its fields to the visitor as runs of window
+    // bytes (Append) each followed by EndField. Every read API goes through
+    // this so they all share the same quoting rules.
+    template <typename TVisitor>
+    bool ScanRow(TVisitor &visitor){
+        DRowEnded = false;
+        if(!Fill(visitor)){
+            DEnd = true;
+            return false;
+        }
+
+        // tracks whether we've seen anything besides a bare newline
+        bool seenContent = false;
+
+        while(true){
+            if(!Fill(visitor)){
+                visitor.EndField();
+                DEnd = true;
+                return true;
+            }
+
+            char ch = *DCursor;
+
+            if(ch == '\n'){
+                DCursor++;
+                // bare newline = empty row, but if we saw content end the field
+                if(seenContent){
+                    visitor.EndField();
+                }
+                DRowEnded = true;
+                // check eof right after newline so End() reflects state immediately
+                if(!Fill(visitor)) DEnd = true;
+                return true;
+            }
+            // quoted field — read until closing quote
+            else if(ch == '"'){
+                DCursor++;
+                seenContent = true;
+                while(Fill(visitor)){
+                    const char *quote = DSVScan::FindQuote(DCursor, DLimit);
+                    visitor.Append(DCursor, quote);
+                    if(quote == DLimit){
+                        // no closing quote in this window, keep going
+                        DCursor = DLimit;
+                        continue;
+                    }
+                    DCursor = quote + 1;
+                    // "" inside quotes is an escaped literal quote
+                    if(Fill(visitor) && *DCursor == '"'){
+                        visitor.Append(DCursor, DCursor + 1);
+                        DCursor++;
+                    }
+                    else{
+                        break;
+                    }
+                }
+            }
+            else if(ch == DDelimiter){
+                DCursor++;
+                visitor.EndField();
+                seenContent = true;
+            }
+            else{
+                // take the whole run of ordinary characters at once
+                const char *start = DCursor;
+                DCursor = DSVScan::FindSpecial(DCursor, DLimit, DDelimiter);
+                visitor.Append(start, DCursor);
+                seenContent = true;
+            }
+        }
+    }
+
+    struct SSkipVisitor {
+        void Append(const char *, const char *){
+        }
+        void EndField(){
+        }
+        bool BeforeRefill(){
+            return true;
+        }
+    };
+
+    struct SRowVisitor {
+        SImplementation &DImpl;
+        std::vector<std::string> &DRow;
+        size_t DColumn = 0;
+        bool DKeep = DImpl.Slot(0) >= 0;
+
+        void Append(const char *begin, const char *end){
+            if(DKeep){
+                DImpl.DField.append(begin, end);
+            }
+        }
+        void EndField(){
+            int Slot = DImpl.Slot(DColumn++);
+            if(DImpl.DProjection.empty()){
+                DRow.emplace_back(DImpl.DField);
+            }
+            else{
+                // projected rows always have one entry per selected column
+                DRow.resize(DImpl.DProjectedCount);
+                if(Slot >= 0){
+                    DRow[Slot] = DImpl.DField;
+                }
+            }
+            DImpl.DField.clear();
+            DKeep = DImpl.Slot(DColumn) >= 0;
+        }
+        bool BeforeRefill(){
+            return true;
+        }
+    };
+
+    struct SViewVisitor {
+        SImplementation &DImpl;
+        size_t DColumn = 0;
+        bool DKeep = DImpl.Slot(0) >= 0;
+
+        void Append(const char *begin, const char *end){
+            if(!DKeep){
+                return;
+            }
+            SFieldRef &Ref = DImpl.DCurrentRef;
+            if(!DImpl.DCurrentStarted){
+                Ref = {begin, 0, size_t(end - begin), false};
+                DImpl.DCurrentStarted = true;
+            }
+            else if(!Ref.DInArena && Ref.DData + Ref.DLength == begin){
+                Ref.DLength += end - begin;
+            }
+            else{
+                // field isn't one contiguous run (escaped quote or window
+                // boundary), so it gets unescaped into the arena
+                if(!Ref.DInArena || Ref.DOffset + Ref.DLength != DImpl.DArena.size()){
+                    CopyToArena(Ref);
+                }
+                DImpl.DArena.append(begin, end);
+                Ref.DLength += end - begin;
+            }
+        }
+        void EndField(){
+            int Slot = DImpl.Slot(DColumn++);
+            if(!DImpl.DCurrentStarted){
+                DImpl.DCurrentRef = {nullptr, 0, 0, false};
+            }
+            if(DImpl.DProjection.empty()){
+                DImpl.DFieldRefs.push_back(DImpl.DCurrentRef);
+            }
+            else{
+                DImpl.DFieldRefs.resize(DImpl.DProjectedCount, {nullptr, 0, 0, false});
+                if(Slot >= 0){
+                    DImpl.DFieldRefs[Slot] = DImpl.DCurrentRef;
+                }
+            }
+            DImpl.DCurrentStarted = false;
+            DKeep = DImpl.Slot(DColumn) >= 0;
+        }
+        bool BeforeRefill(){
+            // the window is about to go away, copy out what still points at it
+            for(auto &Ref : DImpl.DFieldRefs){
+                if(!Ref.DInArena){
+                    CopyToArena(Ref);
+                }
+            }
+            if(DImpl.DCurrentStarted && !DImpl.DCurrentRef.DInArena){
+                CopyToArena(DImpl.DCurrentRef);
+            }
+            return true;
+        }
+        void CopyToArena(SFieldRef &ref){
+            const char *Data = ref.DInArena ? DImpl.DArena.data() + ref.DOffset : ref.DData;
+            size_t Offset = DImpl.DArena.size();
+            // reserve first so Data stays valid when it points into the arena
+            DImpl.DArena.reserve(Offset + ref.DLength);
+            if(ref.DInArena){
+                Data = DImpl.DArena.data() + ref.DOffset;
+            }
+            DImpl.DArena.append(Data, ref.DLength);
+            ref.DOffset = Offset;
+            ref.DInArena = true;
+        }
+    };
+
+    struct SBatchVisitor {
+        SImplementation &DImpl;
+        SDSVColumnBatch &DBatch;
+        size_t DColumn = 0;
+        int DSlot = DImpl.Slot(0);
+
+        SDSVColumn &Column(size_t index){
+            if(index >= DBatch.DColumns.size()){
+                // columns first seen mid-batch are empty for earlier rows
+                size_t Old = DBatch.DColumns.size();
+                SDSVColumn Empty;
+                Empty.DOffsets.assign(DBatch.DRowCount + 1, 0);
+                DBatch.DColumns.resize(index + 1, Empty);
+                for(size_t Index = Old; Index <= index; Index++){
+                    if(SDictionary *Dictionary = DImpl.Dictionary(Index)){
+                        DBatch.DColumns[Index].DOffsets.resize(1);
+                        if(DBatch.DRowCount){
+                            DBatch.DColumns[Index].DCodes.assign(DBatch.DRowCount, Dictionary->Intern(""));
+                        }
+                        DBatch.DColumns[Index].DDictionary = &Dictionary->DValues;
+                    }
+                }
+            }
+            return DBatch.DColumns[index];
+        }
+        void Append(const char *begin, const char *end){
+            if(DSlot >= 0){
+                if(DImpl.Dictionary(DSlot)){
+                    // encoded values are gathered in DField and only interned
+                    DImpl.DField.append(begin, end);
+                }
+                else{
+                    auto &Data = Column(DSlot).DData;
+                    Data.insert(Data.end(), begin, end);
+                }
+            }
+        }
+        void EndField(){
+            if(DSlot >= 0){
+                SDSVColumn &Current = Column(DSlot);
+                if(SDictionary *Dictionary = DImpl.Dictionary(DSlot)){
+                    Current.DCodes.push_back(Dictionary->Intern(DImpl.DField));
+                    DImpl.DField.clear();
+                }
+            }
+            DSlot = DImpl.Slot(++DColumn);
+        }
+        bool BeforeRefill(){
+            return true;
+        }
+        void EndRow(){
+            // each column got at most one value, so this closes it off
+            for(size_t Index = 0; Index < DBatch.DColumns.size(); Index++){
+                SDSVColumn &Current = DBatch.DColumns[Index];
+                if(SDictionary *Dictionary = DImpl.Dictionary(Index)){
+                    if(Current.DCodes.size() == DBatch.DRowCount){
+                        Current.DCodes.push_back(Dictionary->Intern(""));
+                    }
+                }
+                else{
+                    Current.DOffsets.push_back(Current.DData.size());
+                }
+            }
+            DBatch.DRowCount++;
+        }
+    };
+
+    // Hands each field to Store as one view, straight out of the window
+    // unless it had to be unescaped or crossed a refill
+    template <typename TStore>
+    struct SFieldVisitor {
+        SImplementation &DImpl;
+        TStore &DStore;
+        size_t DColumn = 0;
+        int DSlot = DImpl.Slot(0);
+        const char *DData = nullptr;
+        size_t DLength = 0;
+        bool DStarted = false;
+        bool DCopied = false;
+
+        void Append(const char *begin, const char *end){
+            if(DSlot < 0){
+                return;
+            }
+            if(!DStarted){
+                DData = begin;
+                DLength = end - begin;
+                DStarted = true;
+            }
+            else if(!DCopied && DData + DLength == begin){
+                DLength += end - begin;
+            }
+            else{
+                if(!DCopied){
+                    DImpl.DField.assign(DData, DLength);
+                    DCopied = true;
+                }
+                DImpl.DField.append(begin, end);
+            }
+        }
+        void EndField(){
+            if(DSlot >= 0){
+                // empty fields never call Append, so DData may be stale
+                DStore.Store(DSlot, DCopied ? std::string_view(DImpl.DField) : DStarted ? std::string_view(DData, DLength) : std::string_view());
+            }
+            DStarted = DCopied = false;
+            DSlot = DImpl.Slot(++DColumn);
+        }
+        bool BeforeRefill(){
+            if(DStarted && !DCopied){
+                DImpl.DField.assign(DData, DLength);
+                DCopied = true;
+            }
+            return DStore.AllowRefill();
+        }
+    };
+
+    struct STypedStore {
+        const TDSVSchema &DSchema;
+        SDSVTypedBatch &DBatch;
+
+        void Store(size_t slot, std::string_view value){
+            if(slot >= DSchema.size()){
+                return;
+            }
+            SDSVTypedColumn &Column = DBatch.DColumns[slot];
+            bool Valid = !value.empty();
+            if(Column.DType == EDSVType::Int64 || Column.DType == EDSVType::Date){
+                std::int64_t Int = 0;
+                if(Valid){
+                    Valid = Column.DType == EDSVType::Int64 ? DSVSchema::ParseInt64(value, Int) : DSVSchema::ParseDate(value, Int);
+                }
+                Column.DInts.push_back(Valid ? Int : 0);
+            }
+            else if(Column.DType == EDSVType::Double){
+                double Double = 0.0;
+                if(Valid){
+                    Valid = DSVSchema::ParseDouble(value, Double);
+                }
+                Column.DDoubles.push_back(Valid ? Double : 0.0);
+            }
+            else if(Column.DType == EDSVType::Bool){
+                bool Bool = false;
+                if(Valid){
+                    Valid = DSVSchema::ParseBool(value, Bool);
+                }
+                Column.DBools.push_back(Valid && Bool);
+            }
+            else{
+                Column.DStrings.DData.insert(Column.DStrings.DData.end(), value.begin(), value.end());
+                Column.DStrings.DOffsets.push_back(Column.DStrings.DData.size());
+            }
+            // empty values are nulls, anything else that didn't parse is an error
+            if(!Valid && !value.empty()){
+                DBatch.DErrors.push_back({DBatch.DRowCount, slot});
+            }
+            Column.DValid.push_back(Valid);
+        }
+        bool AllowRefill(){
+            return true;
+        }
+        void EndRow(){
+            // columns the row didn't have are nulls
+            for(auto &Column : DBatch.DColumns){
+                if(Column.DValid.size() == DBatch.DRowCount){
+                    Store(&Column - DBatch.DColumns.data(), std::string_view());
+                }
+            }
+            DBatch.DRowCount++;
+        }
+    };
+
+    struct SInferStore {
+        std::vector<EDSVType> DTypes;
+        std::vector<bool> DSeen;
+        std::vector<std::pair<size_t, EDSVType>> DRow;
+        bool DTruncated = false;
+
+        void Store(size_t slot, std::string_view value){
+            if(slot >= DTypes.size()){
+                // columns that are always empty stay strings
+                DTypes.resize(slot + 1, EDSVType::String);
+                DSeen.resize(slot + 1, false);
+            }
+            if(!value.empty()){
+                DRow.emplace_back(slot, DSVSchema::DetectType(value));
+            }
+        }
+        bool AllowRefill(){
+            // sampling stops at the end of the window, InferSchema decides
+            // whether to pull more
+            DTruncated = true;
+            return false;
+        }
+        void EndRow(){
+            for(auto &[Slot, Type] : DRow){
+                if(!DSeen[Slot]){
+                    DTypes[Slot] = Type;
+                    DSeen[Slot] = true;
+                }
+                else if(DTypes[Slot] != Type){
+                    // ints widen to doubles, any other disagreement is a string
+                    bool Numeric = (DTypes[Slot] == EDSVType::Int64 || DTypes[Slot] == EDSVType::Double)
+                        && (Type == EDSVType::Int64 || Type == EDSVType::Double);
+                    DTypes[Slot] = Numeric ? EDSVType::Double : EDSVType::String;
+                }
+            }
+            DRow.clear();
+        }
+    };
+
+    struct SLoadVisitor {
+        bool BeforeRefill(){
+            return true;
+        }
+    };
 };
 
 CDSVReader::CDSVReader(std::shared_ptr<CDataSource> src, char delimiter)
@@ -16,75 +565,216 @@ CDSVReader::CDSVReader(std::shared_ptr<CDataSource> src, char delimiter)
 
 CDSVReader::~CDSVReader() = default;
 
+bool CDSVReader::SelectColumns(const std::vector<std::size_t> &columns) {
+    auto &Impl = *DImplementation;
+    // each column fills one slot, so a repeated column can't be honored
+    std::vector<int> Projection;
+    for(size_t Index = 0; Index < columns.size(); Index++){
+        // slots hold int positions and are indexed by column, so keep both in range
+        if(columns[Index] >= static_cast<std::size_t>(INT_MAX)){
+            return false;
+        }
+        if(columns[Index] >= Projection.size()){
+            Projection.resize(columns[Index] + 1, -1);
+        }
+        if(Projection[columns[Index]] >= 0){
+            return false;
+        }
+        Projection[columns[Index]] = Index;
+    }
+    Impl.DProjection = std::move(Projection);
+    Impl.DProjectedCount = columns.size();
+    return true;
+}
+
+bool CDSVReader::SelectHeaderColumns(const std::vector<std::string> &names) {
+    std::vector<std::string> Header;
+    SelectColumns({});
+    if(!ReadRow(Header)){
+        return false;
+    }
+    std::vector<std::size_t> Columns;
+    bool AllFound = true;
+    for(auto &Name : names){
+        auto Found = std::find(Header.begin(), Header.end(), Name);
+        if(Found == Header.end()){
+            // keep the slot so positions still line up with names, each
+            // missing name gets its own column past the end
+            AllFound = false;
+            Columns.push_back(Header.size() + (&Name - names.data()));
+        }
+        else{
+            Columns.push_back(Found - Header.begin());
+        }
+    }
+    return SelectColumns(Columns) && AllFound;
+}
+
+void CDSVReader::EncodeColumns(const std::vector<std::size_t> &columns) {
+    auto &Impl = *DImplementation;
+    Impl.DDictionaries.clear();
+    for(auto Column : columns){
+        if(Column >= Impl.DDictionaries.size()){
+            Impl.DDictionaries.resize(Column + 1);
+        }
+        Impl.DDictionaries[Column] = std::make_unique<SImplementation::SDictionary>();
+    }
+}
+
+const std::vector<std::string> &CDSVReader::Dictionary(std::size_t column) const {
+    static const std::vector<std::string> Empty;
+    auto Dictionary = DImplementation->Dictionary(column);
+    return Dictionary ? Dictionary->DValues : Empty;
+}
+
 bool CDSVReader::End() const {
     return DImplementation->DEnd;
 }
 
 bool CDSVReader::ReadRow(std::vector<std::string> &row) {
     row.clear();
-    if(DImplementation->DSource->End()){
-        DImplementation->DEnd = true;
+    SImplementation::SRowVisitor Visitor{*DImplementation, row};
+    return DImplementation->ScanRow(Visitor);
+}
+
+bool CDSVReader::SkipRow() {
+    SImplementation::SSkipVisitor Visitor;
+    return DImplementation->ScanRow(Visitor);
+}
+
+std::size_t CDSVReader::Tell() const {
+    auto &Impl = *DImplementation;
+    return Impl.DBase + (Impl.DWindowStart ? Impl.DCursor - Impl.DWindowStart : 0);
+}
+
+bool CDSVReader::SeekOffset(std::size_t offset) {
+    auto &Impl = *DImplementation;
+    // the borrowed window is dropped without being consumed, the source's
+    // position is replaced anyway
+    if(!Impl.DSource->Seek(offset)){
         return false;
     }
+    Impl.DWindowStart = Impl.DCursor = Impl.DLimit = nullptr;
+    Impl.DReplaying = false;
+    Impl.DBase = offset;
+    Impl.DEnd = false;
+    return true;
+}
 
-    std::string field;
-    // tracks whether we've seen anything besides a bare newline
-    bool seenContent = false;
+bool CDSVReader::SeekRow(const CDSVIndex &index, std::size_t row) {
+    std::size_t IndexedRow, Offset;
+    if(!index.Lookup(row, IndexedRow, Offset) || !SeekOffset(Offset)){
+        return false;
+    }
+    for(; IndexedRow < row; IndexedRow++){
+        if(!SkipRow()){
+            return false;
+        }
+    }
+    return true;
+}
 
-    while(true){
-        if(DImplementation->DSource->End()){
-            row.push_back(field);
-            DImplementation->DEnd = true;
-            return true;
+bool CDSVReader::ReadRowView(std::vector<std::string_view> &row) {
+    auto &Impl = *DImplementation;
+    row.clear();
+    Impl.DFieldRefs.clear();
+    Impl.DArena.clear();
+    Impl.DCurrentStarted = false;
+    SImplementation::SViewVisitor Visitor{Impl};
+    if(!Impl.ScanRow(Visitor)){
+        return false;
+    }
+    // the arena may have moved while the row grew, resolve offsets at the end
+    for(auto &Ref : Impl.DFieldRefs){
+        if(Ref.DInArena){
+            row.emplace_back(Impl.DArena.data() + Ref.DOffset, Ref.DLength);
+        }
+        else{
+            row.emplace_back(Ref.DData, Ref.DLength);
         }
+    }
+    return true;
+}
 
-        char ch;
-        DImplementation->DSource->Peek(ch);
+std::size_t CDSVReader::ReadRows(SDSVColumnBatch &batch, std::size_t maxrows) {
+    auto &Impl = *DImplementation;
+    batch.Clear();
+    if(!Impl.DProjection.empty() && batch.DColumns.size() < Impl.DProjectedCount){
+        batch.DColumns.resize(Impl.DProjectedCount);
+    }
+    for(size_t Index = 0; Index < batch.DColumns.size(); Index++){
+        auto Dictionary = Impl.Dictionary(Index);
+        batch.DColumns[Index].DDictionary = Dictionary ? &Dictionary->DValues : nullptr;
+    }
+    Impl.DField.clear();
+    while(batch.DRowCount < maxrows){
+        SImplementation::SBatchVisitor Visitor{Impl, batch};
+        if(!Impl.ScanRow(Visitor)){
+            break;
+        }
+        Visitor.EndRow();
+    }
+    return batch.DRowCount;
+}
 
-        if(ch == '\n'){
-            DImplementation->DSource->Get(ch);
-            // check eof right after newline so End() reflects state immediately
-            if(DImplementation->DSource->End()) DImplementation->DEnd = true;
-            // bare newline = empty row, but if we saw content push the field
-            if(!seenContent && field.empty()){
-                return true;
-            }
-            row.push_back(field);
-            return true;
+std::size_t CDSVReader::ReadTypedRows(const TDSVSchema &schema, SDSVTypedBatch &batch, std::size_t maxrows) {
+    auto &Impl = *DImplementation;
+    batch.Clear();
+    batch.DColumns.resize(schema.size());
+    for(size_t Index = 0; Index < schema.size(); Index++){
+        batch.DColumns[Index].DType = schema[Index];
+    }
+    SImplementation::STypedStore Store{schema, batch};
+    while(batch.DRowCount < maxrows){
+        SImplementation::SFieldVisitor<SImplementation::STypedStore> Visitor{Impl, Store};
+        if(!Impl.ScanRow(Visitor)){
+            break;
         }
-        // quoted field — read until closing quote
-        else if(ch == '"'){
-            DImplementation->DSource->Get(ch);
-            seenContent = true;
-            while(true){
-                if(DImplementation->DSource->End()) break;
-                DImplementation->DSource->Get(ch);
-                if(ch == '"'){
-                    char next;
-                    // "" inside quotes is an escaped literal quote
-                    if(!DImplementation->DSource->End() && DImplementation->DSource->Peek(next) && next == '"'){
-                        DImplementation->DSource->Get(next);
-                        field += '"';
-                    }
-                    else{
-                        break;
-                    }
-                }
-                else{
-                    field += ch;
-                }
+        Store.EndRow();
+    }
+    return batch.DRowCount;
+}
+
+TDSVSchema CDSVReader::InferSchema(std::size_t samplerows) {
+    auto &Impl = *DImplementation;
+    SImplementation::SInferStore Store;
+    SImplementation::SLoadVisitor Loader;
+    // sample what's in the window; if a row runs past it, pull more input in
+    // and sample again, and once the source is drained a cut off row is the
+    // last one
+    bool Drained = !Impl.Fill(Loader);
+    bool Sampled = Drained;
+    while(!Sampled){
+        Store = SImplementation::SInferStore();
+        const char *Cursor = Impl.DCursor;
+        bool End = Impl.DEnd;
+        Sampled = true;
+        for(size_t Row = 0; Row < samplerows; Row++){
+            SImplementation::SFieldVisitor<SImplementation::SInferStore> Visitor{Impl, Store};
+            bool Scanned = Impl.ScanRow(Visitor);
+            if(Store.DTruncated && !Impl.DRowEnded && !Drained){
+                Sampled = false;
+                break;
+            }
+            if(!Scanned){
+                break;
+            }
+            Store.EndRow();
+            if(Store.DTruncated){
+                Sampled = Drained || Row + 1 == samplerows;
+                break;
             }
         }
-        else if(ch == DImplementation->DDelimiter){
-            DImplementation->DSource->Get(ch);
-            row.push_back(field);
-            field.clear();
-            seenContent = true;
-        }
-        else{
-            DImplementation->DSource->Get(ch);
-            field += ch;
-            seenContent = true;
+        // a field cut off by the window may have been copied into DField
+        Impl.DCursor = Cursor;
+        Impl.DEnd = End;
+        Impl.DField.clear();
+        if(!Sampled){
+            Drained = !Impl.ExtendReplay();
         }
     }
+    if(!Impl.DProjection.empty()){
+        Store.DTypes.resize(Impl.DProjectedCount, EDSVType::String);
+    }
+    return Store.DTypes;
 }
@@ -0,0 +1,85 @@
+#include "DSVScan.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define DSVSCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace DSVScan{
+
+static const char *FindSpecialScalar(const char *begin, const char *end, char delimiter) noexcept{
+    while(begin < end && *begin != '\n' && *begin != '"' && *begin != delimiter){
+        begin++;
+    }
+    return begin;
+}
+
+#ifdef DSVSCAN_X86
+
+static const char *FindSpecialSSE2(const char *begin, const char *end, char delimiter) noexcept{
+    const __m128i Newline = _mm_set1_epi8('\n');
+    const __m128i Quote = _mm_set1_epi8('"');
+    const __m128i Delimiter = _mm_set1_epi8(delimiter);
+    while(end - begin >= 16){
+        __m128i Block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        __m128i Matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Block, Newline), _mm_cmpeq_epi8(Block, Quote)), _mm_cmpeq_epi8(Block, Delimiter));
+        int Mask = _mm_movemask_epi8(Matches);
+        if(Mask){
+            return begin + __builtin_ctz(Mask);
+        }
+        begin += 16;
+    }
+    return FindSpecialScalar(begin, end, delimiter);
+}
+
+__attribute__((target("avx2")))
+static const char *FindSpecialAVX2(const char *begin, const char *end, char delimiter) noexcept{
+    const __m256i Newline = _mm256_set1_epi8('\n');
+    const __m256i Quote = _mm256_set1_epi8('"');
+    const __m256i Delimiter = _mm256_set1_epi8(delimiter);
+    while(end - begin >= 32){
+        __m256i Block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        __m256i Matches = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(Block, Newline), _mm256_cmpeq_epi8(Block, Quote)), _mm256_cmpeq_epi8(Block, Delimiter));
+        unsigned int Mask = _mm256_movemask_epi8(Matches);
+        if(Mask){
+            return begin + __builtin_ctz(Mask);
+        }
+        begin += 32;
+    }
+    return FindSpecialSSE2(begin, end, delimiter);
+}
+
+using TFindSpecial = const char *(*)(const char *, const char *, char) noexcept;
+
+// picked once, the first time anything is scanned
+static TFindSpecial SelectFindSpecial() noexcept{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? FindSpecialAVX2 : FindSpecialSSE2;
+}
+
+const char *FindSpecial(const char *begin, const char *end, char delimiter) noexcept{
+    static const TFindSpecial Implementation = SelectFindSpecial();
+    // short runs aren't worth the vector setup
+    if(end - begin < 16){
+        return FindSpecialScalar(begin, end, delimiter);
+    }
+    return Implementation(begin, end, delimiter);
+}
+
+#else
+
+const char *FindSpecial(const char *begin, const char *end, char delimiter) noexcept{
+    return FindSpecialScalar(begin, end, delimiter);
+}
+
+#endif
+
+const char *FindQuote(const char *begin, const char *end) noexcept{
+    // libc's memchr is already vectorized on every platform we build on
+    const void *Quote = begin < end ? std::memchr(begin, '"', end - begin) : nullptr;
+    return Quote ? static_cast<const char *>(Quote) : end;
+}
+
+}
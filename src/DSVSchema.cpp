@@ -0,0 +1,88 @@
+#include "DSVSchema.h"
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+
+namespace DSVSchema{
+
+static bool EqualsIgnoreCase(std::string_view str, std::string_view word) noexcept{
+    if(str.size() != word.size()){
+        return false;
+    }
+    for(size_t Index = 0; Index < str.size(); Index++){
+        if(tolower(static_cast<unsigned char>(str[Index])) != word[Index]){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParseInt64(std::string_view str, std::int64_t &value) noexcept{
+    auto Result = std::from_chars(str.data(), str.data() + str.size(), value);
+    return !str.empty() && Result.ec == std::errc() && Result.ptr == str.data() + str.size();
+}
+
+bool ParseDouble(std::string_view str, double &value) noexcept{
+    // from_chars also takes nan/inf words, which are text in a DSV file
+    auto Result = std::from_chars(str.data(), str.data() + str.size(), value);
+    return !str.empty() && Result.ec == std::errc() && Result.ptr == str.data() + str.size() && std::isfinite(value);
+}
+
+bool ParseBool(std::string_view str, bool &value) noexcept{
+    if(str == "1" || EqualsIgnoreCase(str, "true")){
+        value = true;
+        return true;
+    }
+    if(str == "0" || EqualsIgnoreCase(str, "false")){
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+bool ParseDate(std::string_view str, std::int64_t &days) noexcept{
+    if(str.size() != 10 || str[4] != '-' || str[7] != '-'){
+        return false;
+    }
+    int Year, Month, Day;
+    if(std::from_chars(str.data(), str.data() + 4, Year).ptr != str.data() + 4
+        || std::from_chars(str.data() + 5, str.data() + 7, Month).ptr != str.data() + 7
+        || std::from_chars(str.data() + 8, str.data() + 10, Day).ptr != str.data() + 10){
+        return false;
+    }
+    bool Leap = (Year % 4 == 0 && Year % 100 != 0) || Year % 400 == 0;
+    static const int MonthDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if(Month < 1 || Month > 12 || Day < 1 || Day > MonthDays[Month - 1] + (Month == 2 && Leap)){
+        return false;
+    }
+    // days from civil date, shifted so March starts the year
+    Year -= Month <= 2;
+    std::int64_t Era = (Year >= 0 ? Year : Year - 399) / 400;
+    std::int64_t YearOfEra = Year - Era * 400;
+    std::int64_t DayOfYear = (153 * (Month + (Month > 2 ? -3 : 9)) + 2) / 5 + Day - 1;
+    std::int64_t DayOfEra = YearOfEra * 365 + YearOfEra / 4 - YearOfEra / 100 + DayOfYear;
+    days = Era * 146097 + DayOfEra - 719468;
+    return true;
+}
+
+EDSVType DetectType(std::string_view str) noexcept{
+    bool Bool;
+    std::int64_t Int;
+    double Double;
+    if(!str.empty() && !isdigit(static_cast<unsigned char>(str[0])) && ParseBool(str, Bool)){
+        return EDSVType::Bool;
+    }
+    if(ParseInt64(str, Int)){
+        return EDSVType::Int64;
+    }
+    if(ParseDouble(str, Double)){
+        return EDSVType::Double;
+    }
+    if(ParseDate(str, Int)){
+        return EDSVType::Date;
+    }
+    return EDSVType::String;
+}
+
+}
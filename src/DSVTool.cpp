@@ -0,0 +1,195 @@
+#include "DSVReader.h"
+#include "DSVTransform.h"
+#include "DSVWriter.h"
+#include "FileDataSink.h"
+#include "FileDataSource.h"
+#include "SPSCQueue.h"
+#include "StringUtils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+// dsvtool: streams a DSV input through filter and projection stages to a DSV
+// output. Reading, transforming and writing each run on their own thread,
+// passing batches of rows through bounded lock-free queues.
+
+using namespace DSVTransform;
+
+namespace{
+
+// an empty batch marks the end of the stream, real batches are never empty
+using TBatch = std::vector<TRow>;
+
+constexpr std::size_t BatchRows = 1024;
+constexpr std::size_t QueueBatches = 16;
+constexpr std::size_t OutputFlushSize = 256 * 1024;
+
+struct SOptions{
+    char DInputDelimiter = ',';
+    char DOutputDelimiter = 0;
+    bool DHeader = false;
+    bool DQuoteAll = false;
+    std::vector<std::string> DColumnNames;
+    std::vector<SFilter> DFilters;
+    std::string DInput = "-";
+    std::string DOutput = "-";
+};
+
+void Usage(){
+    std::cerr << "usage: dsvtool [-d delim] [-o delim] [-H] [-c columns] [-f filter]... [-q] [input [output]]\n"
+                 "  -d delim    input delimiter, a character or \"tab\" (default ,)\n"
+                 "  -o delim    output delimiter (default: the input delimiter)\n"
+                 "  -H          the first row is a header, columns can be given by name\n"
+                 "  -c columns  comma separated columns to keep, in output order\n"
+                 "  -f filter   keep rows where column=value, column!=value or\n"
+                 "              column~substring; repeat for more filters, all must match\n"
+                 "  -q          quote every output field\n"
+                 "input and output default to stdin and stdout, - also means either\n";
+}
+
+}
+
+int main(int argc, char *argv[]){
+    SOptions Options;
+    int Option;
+    while((Option = getopt(argc, argv, "d:o:Hc:f:q")) != -1){
+        bool Valid = true;
+        if(Option == 'd'){
+            Valid = ParseDelimiter(optarg, Options.DInputDelimiter);
+        }
+        else if(Option == 'o'){
+            Valid = ParseDelimiter(optarg, Options.DOutputDelimiter);
+        }
+        else if(Option == 'H'){
+            Options.DHeader = true;
+        }
+        else if(Option == 'c'){
+            Options.DColumnNames = StringUtils::Split(optarg, ",");
+        }
+        else if(Option == 'f'){
+            Options.DFilters.emplace_back();
+            Valid = ParseFilter(optarg, Options.DFilters.back());
+        }
+        else if(Option == 'q'){
+            Options.DQuoteAll = true;
+        }
+        else{
+            Valid = false;
+        }
+        if(!Valid){
+            Usage();
+            return 2;
+        }
+    }
+    if(argc - optind > 2){
+        Usage();
+        return 2;
+    }
+    if(optind < argc){
+        Options.DInput = argv[optind++];
+    }
+    if(optind < argc){
+        Options.DOutput = argv[optind++];
+    }
+    if(!Options.DOutputDelimiter){
+        Options.DOutputDelimiter = Options.DInputDelimiter;
+    }
+
+    auto Source = Options.DInput == "-" ? std::make_shared<CFileDataSource>(STDIN_FILENO) : std::make_shared<CFileDataSource>(Options.DInput);
+    if(!Source->IsOpen()){
+        std::cerr << "dsvtool: can't open " << Options.DInput << "\n";
+        return 1;
+    }
+    auto Sink = Options.DOutput == "-" ? std::make_shared<CFileDataSink>(STDOUT_FILENO) : std::make_shared<CFileDataSink>(Options.DOutput);
+    if(!Sink->IsOpen()){
+        std::cerr << "dsvtool: can't create " << Options.DOutput << "\n";
+        return 1;
+    }
+    CDSVReader Reader(Source, Options.DInputDelimiter);
+    CDSVWriter Writer(Sink, Options.DOutputDelimiter, Options.DQuoteAll, OutputFlushSize);
+
+    // the header is read up front so names can be resolved before the
+    // pipeline starts
+    std::vector<std::size_t> Columns;
+    std::string Unknown;
+    if(!StartHeader(Reader, Writer, Options.DHeader, Options.DColumnNames, Columns, Options.DFilters, Unknown)){
+        std::cerr << "dsvtool: unknown column " << Unknown << "\n";
+        return 2;
+    }
+
+    CSPSCQueue<TBatch> ReadQueue(QueueBatches);
+    CSPSCQueue<TBatch> WriteQueue(QueueBatches);
+
+    std::thread ReadThread([&]{
+        TBatch Batch;
+        TRow Row;
+        while(Reader.ReadRow(Row)){
+            Batch.push_back(std::move(Row));
+            if(Batch.size() == BatchRows){
+                ReadQueue.Push(std::move(Batch));
+                Batch = TBatch();
+                Batch.reserve(BatchRows);
+            }
+        }
+        if(!Batch.empty()){
+            ReadQueue.Push(std::move(Batch));
+        }
+        ReadQueue.Push(TBatch());
+    });
+
+    std::thread TransformThread([&]{
+        TBatch Batch;
+        while(true){
+            ReadQueue.Pop(Batch);
+            if(Batch.empty()){
+                WriteQueue.Push(TBatch());
+                return;
+            }
+            TBatch Output;
+            Output.reserve(Batch.size());
+            TRow Projected;
+            for(auto &Row : Batch){
+                bool Keep = std::all_of(Options.DFilters.begin(), Options.DFilters.end(), [&](const SFilter &filter){
+                    return filter.Matches(Row);
+                });
+                if(!Keep){
+                    continue;
+                }
+                // empty rows stay empty, projection would invent fields
+                if(!Columns.empty() && !Row.empty()){
+                    Project(Row, Columns, Projected);
+                    std::swap(Row, Projected);
+                }
+                Output.push_back(std::move(Row));
+            }
+            if(!Output.empty()){
+                WriteQueue.Push(std::move(Output));
+            }
+        }
+    });
+
+    bool Success = true;
+    TBatch Batch;
+    while(true){
+        WriteQueue.Pop(Batch);
+        if(Batch.empty()){
+            break;
+        }
+        for(auto &Row : Batch){
+            Success = Writer.WriteRow(Row) && Success;
+        }
+    }
+    ReadThread.join();
+    TransformThread.join();
+    Success = Writer.Flush() && Sink->Flush() && Success;
+    if(!Success){
+        std::cerr << "dsvtool: write to " << Options.DOutput << " failed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "DSVTransform.h"
+
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+
+namespace DSVTransform{
+
+bool SFilter::Matches(const TRow &row) const{
+    std::string_view Field = DColumn < row.size() ? std::string_view(row[DColumn]) : std::string_view();
+    if(DOp == EFilterOp::Equal){
+        return Field == DValue;
+    }
+    if(DOp == EFilterOp::NotEqual){
+        return Field != DValue;
+    }
+    return Field.find(DValue) != std::string_view::npos;
+}
+
+bool ParseDelimiter(const std::string &arg, char &delimiter){
+    if(arg == "tab" || arg == "\\t"){
+        delimiter = '\t';
+        return true;
+    }
+    if(arg.size() != 1 || arg[0] == '"' || arg[0] == '\n'){
+        return false;
+    }
+    delimiter = arg[0];
+    return true;
+}
+
+bool ParseFilter(const std::string &arg, SFilter &filter){
+    std::size_t Op = arg.find_first_of("=~");
+    if(Op == std::string::npos || Op == 0){
+        return false;
+    }
+    filter.DValue = arg.substr(Op + 1);
+    if(arg[Op] == '~'){
+        filter.DOp = EFilterOp::Contains;
+    }
+    else if(arg[Op - 1] == '!'){
+        filter.DOp = EFilterOp::NotEqual;
+        Op--;
+    }
+    else{
+        filter.DOp = EFilterOp::Equal;
+    }
+    filter.DColumnName = arg.substr(0, Op);
+    return !filter.DColumnName.empty();
+}
+
+bool ResolveColumn(const std::string &name, const TRow &header, std::size_t &column){
+    auto Found = std::find(header.begin(), header.end(), name);
+    if(Found != header.end()){
+        column = Found - header.begin();
+        return true;
+    }
+    auto Result = std::from_chars(name.data(), name.data() + name.size(), column);
+    return Result.ec == std::errc() && Result.ptr == name.data() + name.size();
+}
+
+void Project(TRow &row, const std::vector<std::size_t> &columns, TRow &out){
+    out.resize(columns.size());
+    for(std::size_t Index = 0; Index < columns.size(); Index++){
+        if(columns[Index] < row.size()){
+            // a column can be selected twice, so only the last use may move
+            bool Reused = std::find(columns.begin() + Index + 1, columns.end(), columns[Index]) != columns.end();
+            out[Index] = Reused ? row[columns[Index]] : std::move(row[columns[Index]]);
+        }
+        else{
+            out[Index].clear();
+        }
+    }
+}
+
+bool StartHeader(CDSVReader &reader, CDSVWriter &writer, bool hasheader, const std::vector<std::string> &names, std::vector<std::size_t> &columns, std::vector<SFilter> &filters, std::string &unknown){
+    TRow Header;
+    bool HeaderRead = hasheader && reader.ReadRow(Header);
+    columns.resize(names.size());
+    for(std::size_t Index = 0; Index < columns.size(); Index++){
+        if(!ResolveColumn(names[Index], Header, columns[Index])){
+            unknown = names[Index];
+            return false;
+        }
+    }
+    for(auto &Filter : filters){
+        if(!ResolveColumn(Filter.DColumnName, Header, Filter.DColumn)){
+            unknown = Filter.DColumnName;
+            return false;
+        }
+    }
+    if(HeaderRead){
+        if(!columns.empty()){
+            TRow Projected;
+            Project(Header, columns, Projected);
+            Header = std::move(Projected);
+        }
+        writer.WriteRow(Header);
+    }
+    return true;
+}
+
+}
@@ -1,49 +1,131 @@
 #include "DSVWriter.h"
+#include "DSVScan.h"
+
+#include <charconv>
+#include <limits>
 
 struct CDSVWriter::SImplementation {
     std::shared_ptr<CDataSink> DSink;
     char DDelimiter;
     bool DQuoteAll;
+    // rows are formatted here and handed to the sink in one Write
+    std::string DBuffer;
+    size_t DFlushSize;
+    // fields already in the row being written
+    size_t DRowFields = 0;
+
+    ~SImplementation(){
+        Flush();
+    }
+
+    void AppendField(std::string_view field){
+        // delimiter goes between fields not after the last one
+        if(DRowFields++){
+            DBuffer.push_back(DDelimiter);
+        }
+        const char *Begin = field.data();
+        const char *End = Begin + field.size();
+        // one scan finds the delimiter, a quote or a newline, whichever is first
+        if(!DQuoteAll && DSVScan::FindSpecial(Begin, End, DDelimiter) == End){
+            DBuffer.append(Begin, End);
+            return;
+        }
+        DBuffer.push_back('"');
+        const char *Quote;
+        while((Quote = DSVScan::FindQuote(Begin, End)) != End){
+            // copy through the quote then add another to escape it by doubling
+            DBuffer.append(Begin, Quote + 1);
+            DBuffer.push_back('"');
+            Begin = Quote + 1;
+        }
+        DBuffer.append(Begin, End);
+        DBuffer.push_back('"');
+    }
+
+    template <typename TValue>
+    void AppendNumber(TValue value){
+        // big enough for any 64-bit integer or shortest round-trip double
+        char Text[32];
+        auto Result = std::to_chars(Text, Text + sizeof(Text), value);
+        // still scanned like text since the delimiter could be a digit
+        AppendField(std::string_view(Text, Result.ptr - Text));
+    }
+
+    bool EndRow(){
+        DBuffer.push_back('\n');
+        DRowFields = 0;
+        return DBuffer.size() >= DFlushSize ? Flush() : true;
+    }
+
+    bool Flush(){
+        if(DBuffer.empty()){
+            return true;
+        }
+        bool Success = DSink->Write(DBuffer);
+        DBuffer.clear();
+        return Success;
+    }
 };
 
-CDSVWriter::CDSVWriter(std::shared_ptr<CDataSink> sink, char delimiter, bool quoteall)
+CDSVWriter::CDSVWriter(std::shared_ptr<CDataSink> sink, char delimiter, bool quoteall, std::size_t flushsize)
     : DImplementation(std::make_unique<SImplementation>()) {
     DImplementation->DSink = sink;
     // quote char can't be a delimiter, fall back to comma
     DImplementation->DDelimiter = (delimiter == '"') ? ',' : delimiter;
     DImplementation->DQuoteAll = quoteall;
+    DImplementation->DFlushSize = flushsize;
+    // SIZE_MAX never flushes by size, there's nothing to reserve for
+    if(flushsize != std::numeric_limits<std::size_t>::max()){
+        DImplementation->DBuffer.reserve(flushsize);
+    }
 }
 
 CDSVWriter::~CDSVWriter() = default;
 
 bool CDSVWriter::WriteRow(const std::vector<std::string> &row) {
-    for(size_t i = 0; i < row.size(); i++){
-        const std::string &field = row[i];
-        // need to quote if field has special chars or quoteall is set
-        bool needsQuote = DImplementation->DQuoteAll ||
-            field.find(DImplementation->DDelimiter) != std::string::npos ||
-            field.find('"') != std::string::npos ||
-            field.find('\n') != std::string::npos;
-
-        if(needsQuote){
-            DImplementation->DSink->Put('"');
-            for(char ch : field){
-                if(ch == '"') DImplementation->DSink->Put('"'); // escape quotes by doubling
-                DImplementation->DSink->Put(ch);
-            }
-            DImplementation->DSink->Put('"');
-        }
-        else{
-            for(char ch : field){
-                DImplementation->DSink->Put(ch);
-            }
-        }
+    for(auto &Field : row){
+        DImplementation->AppendField(Field);
+    }
+    return DImplementation->EndRow();
+}
 
-        // delimiter goes between fields not after the last one
-        if(i < row.size() - 1){
-            DImplementation->DSink->Put(DImplementation->DDelimiter);
-        }
+bool CDSVWriter::WriteViews(std::span<const std::string_view> row) {
+    for(auto Field : row){
+        DImplementation->AppendField(Field);
     }
-    DImplementation->DSink->Put('\n');
-    return true;
+    return DImplementation->EndRow();
+}
+
+void CDSVWriter::WriteText(std::string_view field) {
+    DImplementation->AppendField(field);
+}
+
+void CDSVWriter::WriteSigned(long long value) {
+    DImplementation->AppendNumber(value);
+}
+
+void CDSVWriter::WriteUnsigned(unsigned long long value) {
+    DImplementation->AppendNumber(value);
+}
+
+void CDSVWriter::WriteFloat(float value) {
+    DImplementation->AppendNumber(value);
+}
+
+void CDSVWriter::WriteDouble(double value) {
+    DImplementation->AppendNumber(value);
+}
+
+bool CDSVWriter::EndRow() {
+    return DImplementation->EndRow();
+}
+
+bool CDSVWriter::Flush() {
+    return DImplementation->Flush();
+}
+
+std::string CDSVWriter::TakeBuffered() {
+    std::string Buffered = std::move(DImplementation->DBuffer);
+    DImplementation->DBuffer.clear();
+    return Buffered;
 }
@@ -0,0 +1,83 @@
+#include "FileDataSink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+CFileDataSink::CFileDataSink(int fd, std::size_t bufsize)
+    : DFileDescriptor(fd), DOwned(false), DBuffer(std::max<std::size_t>(bufsize, 1)), DLength(0){
+
+}
+
+CFileDataSink::CFileDataSink(const std::string &filename, std::size_t bufsize)
+    : CFileDataSink(open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644), bufsize){
+    DOwned = DFileDescriptor >= 0;
+}
+
+CFileDataSink::~CFileDataSink(){
+    Flush();
+    if(DOwned){
+        close(DFileDescriptor);
+    }
+}
+
+bool CFileDataSink::WriteAll(const char *data, std::size_t length) noexcept{
+    if(DFileDescriptor < 0){
+        return false;
+    }
+    while(length){
+        ssize_t Result = write(DFileDescriptor, data, length);
+        if(Result < 0){
+            // retry writes interrupted by a signal
+            if(errno == EINTR){
+                continue;
+            }
+            return false;
+        }
+        data += Result;
+        length -= Result;
+    }
+    return true;
+}
+
+bool CFileDataSink::IsOpen() const noexcept{
+    return DFileDescriptor >= 0;
+}
+
+bool CFileDataSink::Flush() noexcept{
+    bool Success = WriteAll(DBuffer.data(), DLength);
+    DLength = 0;
+    return Success;
+}
+
+bool CFileDataSink::Put(const char &ch) noexcept{
+    if(DLength == DBuffer.size() && !Flush()){
+        return false;
+    }
+    DBuffer[DLength++] = ch;
+    return true;
+}
+
+bool CFileDataSink::Write(const std::vector<char> &buf) noexcept{
+    return Write(buf.data(), buf.size());
+}
+
+bool CFileDataSink::Write(const char *data, std::size_t length) noexcept{
+    if(DLength + length > DBuffer.size()){
+        if(!Flush()){
+            return false;
+        }
+        // too big to be worth buffering, hand it straight to the kernel
+        if(length >= DBuffer.size()){
+            return WriteAll(data, length);
+        }
+    }
+    if(length){
+        std::memcpy(DBuffer.data() + DLength, data, length);
+        DLength += length;
+    }
+    return true;
+}
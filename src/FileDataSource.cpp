@@ -0,0 +1,120 @@
+#include "FileDataSource.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CFileDataSource::CFileDataSource(int fd, std::size_t bufsize)
+    : DFileDescriptor(fd), DOwned(false), DBuffer(std::max<std::size_t>(bufsize, 1)), DIndex(0), DLength(0), DEOF(fd < 0){
+
+}
+
+CFileDataSource::CFileDataSource(const std::string &filename, std::size_t bufsize)
+    : CFileDataSource(open(filename.c_str(), O_RDONLY), bufsize){
+    DOwned = DFileDescriptor >= 0;
+}
+
+CFileDataSource::~CFileDataSource(){
+    if(DOwned){
+        close(DFileDescriptor);
+    }
+}
+
+bool CFileDataSource::Fill() const noexcept{
+    if(DIndex < DLength){
+        return true;
+    }
+    DIndex = 0;
+    DLength = 0;
+    while(!DEOF){
+        ssize_t Result = read(DFileDescriptor, DBuffer.data(), DBuffer.size());
+        if(Result > 0){
+            DLength = Result;
+            return true;
+        }
+        // retry reads interrupted by a signal, anything else ends the stream
+        if(Result < 0 && errno == EINTR){
+            continue;
+        }
+        DEOF = true;
+    }
+    return false;
+}
+
+bool CFileDataSource::IsOpen() const noexcept{
+    return DFileDescriptor >= 0;
+}
+
+bool CFileDataSource::End() const noexcept{
+    return !Fill();
+}
+
+bool CFileDataSource::Get(char &ch) noexcept{
+    if(Fill()){
+        ch = DBuffer[DIndex];
+        DIndex++;
+        return true;
+    }
+    return false;
+}
+
+bool CFileDataSource::Peek(char &ch) noexcept{
+    if(Fill()){
+        ch = DBuffer[DIndex];
+        return true;
+    }
+    return false;
+}
+
+bool CFileDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    while(buf.size() < count && Fill()){
+        std::size_t Length = std::min(count - buf.size(), DLength - DIndex);
+        buf.insert(buf.end(), DBuffer.data() + DIndex, DBuffer.data() + DIndex + Length);
+        DIndex += Length;
+    }
+    return !buf.empty();
+}
+
+bool CFileDataSource::Window(const char *&data, std::size_t &length) noexcept{
+    if(Fill()){
+        data = DBuffer.data() + DIndex;
+        length = DLength - DIndex;
+        return true;
+    }
+    data = nullptr;
+    length = 0;
+    return false;
+}
+
+std::size_t CFileDataSource::Consume(std::size_t count) noexcept{
+    std::size_t Consumed = 0;
+    while(Consumed < count && Fill()){
+        std::size_t Length = std::min(count - Consumed, DLength - DIndex);
+        DIndex += Length;
+        Consumed += Length;
+    }
+    return Consumed;
+}
+
+bool CFileDataSource::Seek(std::size_t offset) noexcept{
+    // lseek would happily go past the end of a file, so check the size;
+    // pipes and terminals fail the lseek with ESPIPE
+    struct stat Status;
+    if(DFileDescriptor < 0 || fstat(DFileDescriptor, &Status) < 0){
+        return false;
+    }
+    if(S_ISREG(Status.st_mode) && offset > static_cast<std::size_t>(Status.st_size)){
+        return false;
+    }
+    if(lseek(DFileDescriptor, offset, SEEK_SET) < 0){
+        return false;
+    }
+    DIndex = 0;
+    DLength = 0;
+    DEOF = false;
+    return true;
+}
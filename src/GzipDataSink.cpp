@@ -0,0 +1,94 @@
+#include "GzipDataSink.h"
+
+#include <algorithm>
+
+CGzipDataSink::CGzipDataSink(std::shared_ptr<CDataSink> sink, int level, std::size_t bufsize, std::size_t maxslice)
+    : DSink(sink), DOutput(std::max<std::size_t>(bufsize, 1)), DFinished(false), DError(false), DMaxSlice(std::clamp<std::size_t>(maxslice, 1, UINT_MAX)){
+    DStream = z_stream{};
+    DInput.reserve(DOutput.size());
+    // 16 added to the window bits writes a gzip header and trailer
+    if(deflateInit2(&DStream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK){
+        DError = true;
+    }
+}
+
+CGzipDataSink::~CGzipDataSink(){
+    Finish();
+    deflateEnd(&DStream);
+}
+
+bool CGzipDataSink::Deflate(const char *data, std::size_t length, int flush) noexcept{
+    DStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    std::size_t Remaining = length;
+    while(true){
+        if(DStream.avail_in == 0 && Remaining){
+            DStream.avail_in = std::min<std::size_t>(Remaining, DMaxSlice);
+            Remaining -= DStream.avail_in;
+        }
+        DStream.next_out = reinterpret_cast<Bytef *>(DOutput.data());
+        DStream.avail_out = DOutput.size();
+        int Result = deflate(&DStream, Remaining ? Z_NO_FLUSH : flush);
+        if(Result == Z_STREAM_ERROR){
+            DError = true;
+            return false;
+        }
+        std::size_t Produced = DOutput.size() - DStream.avail_out;
+        if(Produced && !DSink->Write(DOutput.data(), Produced)){
+            DError = true;
+            return false;
+        }
+        // a full output buffer means deflate may have more to hand out
+        if(DStream.avail_out != 0 && DStream.avail_in == 0 && !Remaining){
+            return true;
+        }
+    }
+}
+
+bool CGzipDataSink::Flush() noexcept{
+    if(DFinished || DError){
+        return false;
+    }
+    bool Success = Deflate(DInput.data(), DInput.size(), Z_SYNC_FLUSH);
+    DInput.clear();
+    return Success;
+}
+
+bool CGzipDataSink::Finish() noexcept{
+    if(DFinished || DError){
+        return !DError;
+    }
+    DFinished = true;
+    bool Success = Deflate(DInput.data(), DInput.size(), Z_FINISH);
+    DInput.clear();
+    return Success;
+}
+
+bool CGzipDataSink::Put(const char &ch) noexcept{
+    return Write(&ch, 1);
+}
+
+bool CGzipDataSink::Write(const std::vector<char> &buf) noexcept{
+    return Write(buf.data(), buf.size());
+}
+
+bool CGzipDataSink::Write(const char *data, std::size_t length) noexcept{
+    if(DFinished || DError){
+        return false;
+    }
+    // small writes are staged so deflate always sees large blocks
+    if(DInput.size() + length <= DInput.capacity()){
+        DInput.insert(DInput.end(), data, data + length);
+        return true;
+    }
+    if(!DInput.empty()){
+        if(!Deflate(DInput.data(), DInput.size(), Z_NO_FLUSH)){
+            return false;
+        }
+        DInput.clear();
+    }
+    if(length >= DInput.capacity()){
+        return Deflate(data, length, Z_NO_FLUSH);
+    }
+    DInput.insert(DInput.end(), data, data + length);
+    return true;
+}
@@ -0,0 +1,106 @@
+#include "GzipDataSource.h"
+
+#include <algorithm>
+
+CGzipDataSource::CGzipDataSource(std::shared_ptr<CDataSource> src, std::size_t bufsize)
+    : DSource(src), DBuffer(std::max<std::size_t>(bufsize, 1)), DIndex(0), DLength(0), DDone(false){
+    DStream = z_stream{};
+    // 32 added to the window bits auto-detects gzip or zlib headers
+    if(inflateInit2(&DStream, 15 + 32) != Z_OK){
+        DDone = true;
+    }
+}
+
+CGzipDataSource::~CGzipDataSource(){
+    inflateEnd(&DStream);
+}
+
+bool CGzipDataSource::Fill() const noexcept{
+    if(DIndex < DLength){
+        return true;
+    }
+    DIndex = 0;
+    DLength = 0;
+    while(!DDone && !DLength){
+        const char *Data;
+        std::size_t Length;
+        if(!DSource->Window(Data, Length)){
+            // input ran out, fine only if the last member was complete
+            DDone = true;
+            break;
+        }
+        Length = std::min<std::size_t>(Length, UINT_MAX);
+        DStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(Data));
+        DStream.avail_in = Length;
+        DStream.next_out = reinterpret_cast<Bytef *>(DBuffer.data());
+        DStream.avail_out = DBuffer.size();
+        int Result = inflate(&DStream, Z_NO_FLUSH);
+        DSource->Consume(Length - DStream.avail_in);
+        DLength = DBuffer.size() - DStream.avail_out;
+        if(Result == Z_STREAM_END){
+            // concatenated gzip members decode as one stream
+            inflateReset(&DStream);
+        }
+        else if(Result != Z_OK && Result != Z_BUF_ERROR){
+            DDone = true;
+        }
+    }
+    return DLength > 0;
+}
+
+bool CGzipDataSource::Error() const noexcept{
+    // total_in is reset between members, so a pending member is unfinished
+    return DDone && (DStream.msg != nullptr || DStream.total_in != 0);
+}
+
+bool CGzipDataSource::End() const noexcept{
+    return !Fill();
+}
+
+bool CGzipDataSource::Get(char &ch) noexcept{
+    if(Fill()){
+        ch = DBuffer[DIndex];
+        DIndex++;
+        return true;
+    }
+    return false;
+}
+
+bool CGzipDataSource::Peek(char &ch) noexcept{
+    if(Fill()){
+        ch = DBuffer[DIndex];
+        return true;
+    }
+    return false;
+}
+
+bool CGzipDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    while(buf.size() < count && Fill()){
+        std::size_t Length = std::min(count - buf.size(), DLength - DIndex);
+        buf.insert(buf.end(), DBuffer.data() + DIndex, DBuffer.data() + DIndex + Length);
+        DIndex += Length;
+    }
+    return !buf.empty();
+}
+
+bool CGzipDataSource::Window(const char *&data, std::size_t &length) noexcept{
+    if(Fill()){
+        data = DBuffer.data() + DIndex;
+        length = DLength - DIndex;
+        return true;
+    }
+    data = nullptr;
+    length = 0;
+    return false;
+}
+
+std::size_t CGzipDataSource::Consume(std::size_t count) noexcept{
+    std::size_t Consumed = 0;
+    while(Consumed < count && Fill()){
+        std::size_t Length = std::min(count - Consumed, DLength - DIndex);
+        DIndex += Length;
+        Consumed += Length;
+    }
+    return Consumed;
+}
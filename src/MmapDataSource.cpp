@@ -0,0 +1,107 @@
+#include "MmapDataSource.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CMmapDataSource::CMmapDataSource(const std::string &filename) : DData(nullptr), DSize(0), DIndex(0), DOpen(false){
+    int FileDescriptor = open(filename.c_str(), O_RDONLY);
+    if(FileDescriptor < 0){
+        return;
+    }
+    struct stat FileStat;
+    if(fstat(FileDescriptor, &FileStat) == 0){
+        DSize = FileStat.st_size;
+        // mmap can't map zero bytes, an empty file is just an empty source
+        if(DSize == 0){
+            DOpen = true;
+        }
+        else{
+            void *Mapping = mmap(nullptr, DSize, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+            if(Mapping != MAP_FAILED){
+                // readers walk the file front to back
+                madvise(Mapping, DSize, MADV_SEQUENTIAL);
+                DData = static_cast<const char *>(Mapping);
+                DOpen = true;
+            }
+            else{
+                DSize = 0;
+            }
+        }
+    }
+    // the mapping stays valid after the descriptor is closed
+    close(FileDescriptor);
+}
+
+CMmapDataSource::~CMmapDataSource(){
+    if(DData){
+        munmap(const_cast<char *>(DData), DSize);
+    }
+}
+
+bool CMmapDataSource::IsOpen() const noexcept{
+    return DOpen;
+}
+
+const char *CMmapDataSource::Data() const noexcept{
+    return DData;
+}
+
+std::size_t CMmapDataSource::Size() const noexcept{
+    return DSize;
+}
+
+std::size_t CMmapDataSource::Position() const noexcept{
+    return DIndex;
+}
+
+bool CMmapDataSource::End() const noexcept{
+    return DIndex >= DSize;
+}
+
+bool CMmapDataSource::Get(char &ch) noexcept{
+    if(DIndex < DSize){
+        ch = DData[DIndex];
+        DIndex++;
+        return true;
+    }
+    return false;
+}
+
+bool CMmapDataSource::Peek(char &ch) noexcept{
+    if(DIndex < DSize){
+        ch = DData[DIndex];
+        return true;
+    }
+    return false;
+}
+
+bool CMmapDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    std::size_t Length = std::min(count, DSize - DIndex);
+    buf.assign(DData + DIndex, DData + DIndex + Length);
+    DIndex += Length;
+    return !buf.empty();
+}
+
+bool CMmapDataSource::Window(const char *&data, std::size_t &length) noexcept{
+    data = DData + DIndex;
+    length = DSize - DIndex;
+    return length > 0;
+}
+
+std::size_t CMmapDataSource::Consume(std::size_t count) noexcept{
+    std::size_t Length = std::min(count, DSize - DIndex);
+    DIndex += Length;
+    return Length;
+}
+
+bool CMmapDataSource::Seek(std::size_t offset) noexcept{
+    if(offset > DSize){
+        return false;
+    }
+    DIndex = offset;
+    return true;
+}
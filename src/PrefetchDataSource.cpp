@@ -0,0 +1,125 @@
+#include "PrefetchDataSource.h"
+
+#include <algorithm>
+
+CPrefetchDataSource::CPrefetchDataSource(std::shared_ptr<CDataSource> src, std::size_t bufsize, std::size_t queuedepth)
+    : DSource(src), DBuffers(std::max<std::size_t>(queuedepth, 1)), DBufferSize(std::max<std::size_t>(bufsize, 1)),
+      DHead(0), DFilled(0), DIndex(0), DHolding(false), DSourceDone(false), DStop(false){
+    for(auto &Buffer : DBuffers){
+        Buffer.reserve(DBufferSize);
+    }
+    DThread = std::thread(&CPrefetchDataSource::Prefetch, this);
+}
+
+CPrefetchDataSource::~CPrefetchDataSource(){
+    {
+        std::lock_guard<std::mutex> Lock(DMutex);
+        DStop = true;
+    }
+    DFreeCondition.notify_all();
+    DThread.join();
+}
+
+void CPrefetchDataSource::Prefetch(){
+    std::unique_lock<std::mutex> Lock(DMutex);
+    while(true){
+        DFreeCondition.wait(Lock, [this]{ return DStop || DFilled < DBuffers.size(); });
+        if(DStop){
+            return;
+        }
+        // the slot after the filled ones is only touched by this thread
+        std::vector<char> &Buffer = DBuffers[(DHead + DFilled) % DBuffers.size()];
+        Lock.unlock();
+        bool Success = DSource->Read(Buffer, DBufferSize);
+        Lock.lock();
+        if(!Success){
+            DSourceDone = true;
+            DFilledCondition.notify_all();
+            return;
+        }
+        DFilled++;
+        DFilledCondition.notify_all();
+    }
+}
+
+bool CPrefetchDataSource::Fill() const noexcept{
+    if(DHolding && DIndex < DBuffers[DHead].size()){
+        return true;
+    }
+    std::unique_lock<std::mutex> Lock(DMutex);
+    if(DHolding){
+        // hand the drained buffer back to the prefetch thread
+        DHead = (DHead + 1) % DBuffers.size();
+        DFilled--;
+        DHolding = false;
+        DFreeCondition.notify_all();
+    }
+    DFilledCondition.wait(Lock, [this]{ return DFilled > 0 || DSourceDone; });
+    if(!DFilled){
+        return false;
+    }
+    DHolding = true;
+    DIndex = 0;
+    return true;
+}
+
+std::size_t CPrefetchDataSource::BufferSize() const noexcept{
+    return DBufferSize;
+}
+
+std::size_t CPrefetchDataSource::QueueDepth() const noexcept{
+    return DBuffers.size();
+}
+
+bool CPrefetchDataSource::End() const noexcept{
+    return !Fill();
+}
+
+bool CPrefetchDataSource::Get(char &ch) noexcept{
+    if(Fill()){
+        ch = DBuffers[DHead][DIndex];
+        DIndex++;
+        return true;
+    }
+    return false;
+}
+
+bool CPrefetchDataSource::Peek(char &ch) noexcept{
+    if(Fill()){
+        ch = DBuffers[DHead][DIndex];
+        return true;
+    }
+    return false;
+}
+
+bool CPrefetchDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    while(buf.size() < count && Fill()){
+        const std::vector<char> &Buffer = DBuffers[DHead];
+        std::size_t Length = std::min(count - buf.size(), Buffer.size() - DIndex);
+        buf.insert(buf.end(), Buffer.data() + DIndex, Buffer.data() + DIndex + Length);
+        DIndex += Length;
+    }
+    return !buf.empty();
+}
+
+bool CPrefetchDataSource::Window(const char *&data, std::size_t &length) noexcept{
+    if(Fill()){
+        data = DBuffers[DHead].data() + DIndex;
+        length = DBuffers[DHead].size() - DIndex;
+        return true;
+    }
+    data = nullptr;
+    length = 0;
+    return false;
+}
+
+std::size_t CPrefetchDataSource::Consume(std::size_t count) noexcept{
+    std::size_t Consumed = 0;
+    while(Consumed < count && Fill()){
+        std::size_t Length = std::min(count - Consumed, DBuffers[DHead].size() - DIndex);
+        DIndex += Length;
+        Consumed += Length;
+    }
+    return Consumed;
+}
@@ -1,15 +1,33 @@
 #include "StringDataSink.h"
 
+#include <utility>
+
 const std::string &CStringDataSink::String() const{
     return DString;
 }
 
+void CStringDataSink::Reserve(std::size_t size){
+    DString.reserve(size);
+}
+
+std::string CStringDataSink::Take() noexcept{
+    // moved-from strings are valid but unspecified, leave the sink empty
+    std::string Result = std::move(DString);
+    DString.clear();
+    return Result;
+}
+
 bool CStringDataSink::Put(const char &ch) noexcept{
-    DString += std::string(1,ch);
+    DString.push_back(ch);
     return true;
 }
 
 bool CStringDataSink::Write(const std::vector<char> &buf) noexcept{
-    DString += std::string(buf.data(),buf.size());
+    DString.append(buf.data(),buf.size());
+    return true;
+}
+
+bool CStringDataSink::Write(const char *data, std::size_t length) noexcept{
+    DString.append(data,length);
     return true;
 }
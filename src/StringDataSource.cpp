@@ -1,16 +1,36 @@
 #include "StringDataSource.h"
 
-CStringDataSource::CStringDataSource(const std::string &str) : DString(str), DIndex(0){
+#include <algorithm>
+#include <utility>
+
+CStringDataSource::CStringDataSource(const std::string &str) : DString(str), DView(DString), DBorrowed(false), DIndex(0){
+
+}
+
+CStringDataSource::CStringDataSource(const char *str) : DString(str), DView(DString), DBorrowed(false), DIndex(0){
+
+}
+
+CStringDataSource::CStringDataSource(std::string &&str) : DString(std::move(str)), DView(DString), DBorrowed(false), DIndex(0){
+
+}
+
+CStringDataSource::CStringDataSource(std::string_view str) : DView(str), DBorrowed(true), DIndex(0){
+
+}
+
+CStringDataSource::CStringDataSource(const CStringDataSource &source)
+    : DString(source.DString), DView(source.DBorrowed ? source.DView : std::string_view(DString)), DBorrowed(source.DBorrowed), DIndex(source.DIndex){
 
 }
 
 bool CStringDataSource::End() const noexcept{
-    return DIndex >= DString.length();
+    return DIndex >= DView.length();
 }
 
 bool CStringDataSource::Get(char &ch) noexcept{
-    if(DIndex < DString.length()){
-        ch = DString[DIndex];
+    if(DIndex < DView.length()){
+        ch = DView[DIndex];
         DIndex++;
         return true;
     }
@@ -18,23 +38,36 @@ bool CStringDataSource::Get(char &ch) noexcept{
 }
 
 bool CStringDataSource::Peek(char &ch) noexcept{
-    if(DIndex < DString.length()){
-        ch = DString[DIndex];
+    if(DIndex < DView.length()){
+        ch = DView[DIndex];
         return true;
     }
     return false;
 }
 
 bool CStringDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
-    buf.clear();
-    while(buf.size() < count){
-        char TempChar;
-        if(Get(TempChar)){
-            buf.push_back(TempChar);
-        }
-        else{
-            break;
-        }
-    }
+    std::size_t Length = DIndex < DView.length() ? std::min(count, DView.length() - DIndex) : 0;
+    buf.assign(DView.data() + DIndex, DView.data() + DIndex + Length);
+    DIndex += Length;
     return !buf.empty();
 }
+
+bool CStringDataSource::Window(const char *&data, std::size_t &length) noexcept{
+    data = DView.data() + DIndex;
+    length = DIndex < DView.length() ? DView.length() - DIndex : 0;
+    return length > 0;
+}
+
+std::size_t CStringDataSource::Consume(std::size_t count) noexcept{
+    std::size_t Length = DIndex < DView.length() ? std::min(count, DView.length() - DIndex) : 0;
+    DIndex += Length;
+    return Length;
+}
+
+bool CStringDataSource::Seek(std::size_t offset) noexcept{
+    if(offset > DView.length()){
+        return false;
+    }
+    DIndex = offset;
+    return true;
+}
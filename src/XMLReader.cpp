@@ -2,21 +2,49 @@
 
 #include <expat.h>
 
-#include <deque>
+#include <algorithm>
+#include <climits>
 #include <string>
+#include <utility>
 #include <vector>
 
 struct CXMLReader::SImplementation {
+    static constexpr std::size_t InitialQueueSize = 16;
+
     std::shared_ptr<CDataSource> DSource;
     XML_Parser DParser;
-    std::deque<SXMLEntity> DQueue;
+    std::size_t DChunkSize;
+    // the parser is suspended once this many entities are waiting
+    std::size_t DMaxQueued;
+    bool DSuspended;
+    bool DFinalSubmitted;
+    // longest CharData entity in bytes, 0 delivers each text run whole
+    std::size_t DCharDataLimit;
+    // open elements left to discard for SkipElement, callbacks build nothing
+    // while this is non-zero
+    std::size_t DSkipDepth;
+    // whether the entity last handed out was a StartElement
+    bool DLastWasStart;
+    // Ring of queued entities. Slots are never freed, so the strings and
+    // attribute vectors of delivered entities are reused by later callbacks
+    // instead of being allocated again. The size is a power of two.
+    std::vector<SXMLEntity> DQueue;
+    std::size_t DQueueHead;
+    std::size_t DQueueCount;
+    // attribute vectors taken off entities that don't need them, kept whole
+    // so their strings' capacity survives until the next start element
+    std::vector<TAttributes> DSpareAttributes;
+    // pairs left over when a recycled vector is longer than needed, handed
+    // to the next element with more attributes than its vector holds
+    TAttributes DSparePairs;
     bool DParsedFinal;
 
     // Buffer character data between element callbacks
     std::string DCharBuffer;
 
-    SImplementation(std::shared_ptr<CDataSource> src)
-        : DSource(src), DParser(nullptr), DParsedFinal(false) {
+    SImplementation(std::shared_ptr<CDataSource> src, std::size_t chunksize, std::size_t maxqueued)
+        : DSource(src), DParser(nullptr), DChunkSize(std::clamp<std::size_t>(chunksize, 1, INT_MAX)),
+          DMaxQueued(std::max<std::size_t>(maxqueued, 1)), DSuspended(false), DFinalSubmitted(false), DCharDataLimit(0), DSkipDepth(0), DLastWasStart(false), DQueue(InitialQueueSize), DQueueHead(0), DQueueCount(0), DParsedFinal(false) {
 
         DParser = XML_ParserCreate(nullptr);
         XML_SetUserData(DParser, this);
@@ -32,59 +60,169 @@ struct CXMLReader::SImplementation {
         }
     }
 
+    SXMLEntity &QueueSlot(std::size_t index) {
+        return DQueue[(DQueueHead + index) & (DQueue.size() - 1)];
+    }
+
+    // Claims the next free slot, keeping whatever capacity it already has
+    SXMLEntity &PushEntity(SXMLEntity::EType type) {
+        if (DQueueCount == DQueue.size()) {
+            std::vector<SXMLEntity> Grown(DQueue.size() * 2);
+            for (std::size_t Index = 0; Index < DQueueCount; Index++) {
+                Grown[Index] = std::move(QueueSlot(Index));
+            }
+            DQueue = std::move(Grown);
+            DQueueHead = 0;
+        }
+        SXMLEntity &Entity = QueueSlot(DQueueCount++);
+        Entity.DType = type;
+        if (!Entity.DAttributes.empty()) {
+            DSpareAttributes.push_back(std::move(Entity.DAttributes));
+            Entity.DAttributes.clear();
+        }
+        return Entity;
+    }
+
+    // Hands the oldest entity over by swapping, the caller's old buffers
+    // become the slot's spares
+    void PopEntity(SXMLEntity *entity) {
+        if (entity) {
+            std::swap(*entity, QueueSlot(0));
+        }
+        DQueueHead = (DQueueHead + 1) & (DQueue.size() - 1);
+        DQueueCount--;
+    }
+
+    // Suspends the parser once enough entities wait for the consumer.
+    // Checked when elements end so a start element still in the queue can
+    // become a CompleteElement; starts alone only stop at twice the limit.
+    void LimitQueue(std::size_t limit) {
+        if (DQueueCount >= limit) {
+            XML_ParsingStatus status;
+            XML_GetParsingStatus(DParser, &status);
+            if (status.parsing == XML_PARSING) {
+                XML_StopParser(DParser, XML_TRUE);
+            }
+        }
+    }
+
+    // Starts discarding at the given depth, text isn't even reported to us
+    // until the skipped element ends
+    void BeginSkip(std::size_t depth) {
+        DSkipDepth = depth;
+        DCharBuffer.clear();
+        XML_SetCharacterDataHandler(DParser, nullptr);
+    }
+
     static void StartElementHandler(void *userdata, const XML_Char *name, const XML_Char **atts) {
         auto *impl = static_cast<SImplementation *>(userdata);
+        if (impl->DSkipDepth) {
+            impl->DSkipDepth++;
+            return;
+        }
 
         // Flush any pending char data before starting a new element
         impl->FlushCharDataToQueue();
 
-        SXMLEntity ent;
-        ent.DType = SXMLEntity::EType::StartElement;
-        ent.DNameData = name;
+        SXMLEntity &ent = impl->PushEntity(SXMLEntity::EType::StartElement);
+        ent.DNameData.assign(name);
 
-        for (int i = 0; atts && atts[i]; i += 2) {
-            std::string key = atts[i];
-            std::string val = atts[i + 1] ? atts[i + 1] : "";
-            ent.DAttributes.push_back(std::make_pair(key, val));
+        std::size_t count = 0;
+        while (atts && atts[count * 2]) {
+            count++;
         }
-
-        impl->DQueue.push_back(ent);
+        // assign into recycled pairs so their strings keep their capacity
+        if (count && !impl->DSpareAttributes.empty()) {
+            ent.DAttributes = std::move(impl->DSpareAttributes.back());
+            impl->DSpareAttributes.pop_back();
+        }
+        TAttributes &attrs = ent.DAttributes;
+        while (attrs.size() > count) {
+            impl->DSparePairs.push_back(std::move(attrs.back()));
+            attrs.pop_back();
+        }
+        while (attrs.size() < count) {
+            if (impl->DSparePairs.empty()) {
+                attrs.emplace_back();
+            } else {
+                attrs.push_back(std::move(impl->DSparePairs.back()));
+                impl->DSparePairs.pop_back();
+            }
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            ent.DAttributes[i].first.assign(atts[i * 2]);
+            ent.DAttributes[i].second.assign(atts[i * 2 + 1] ? atts[i * 2 + 1] : "");
+        }
+        impl->LimitQueue(impl->DMaxQueued * 2);
     }
 
     static void EndElementHandler(void *userdata, const XML_Char *name) {
         auto *impl = static_cast<SImplementation *>(userdata);
+        if (impl->DSkipDepth) {
+            if (!--impl->DSkipDepth) {
+                XML_SetCharacterDataHandler(impl->DParser, CharacterDataHandler);
+            }
+            return;
+        }
 
         // Flush any pending char data before ending an element
         impl->FlushCharDataToQueue();
 
         // Checking if the last entity was a start element with the same name
-        if (!impl->DQueue.empty()) {
-            const SXMLEntity &last = impl->DQueue.back();
+        if (impl->DQueueCount) {
+            SXMLEntity &last = impl->QueueSlot(impl->DQueueCount - 1);
             if (last.DType == SXMLEntity::EType::StartElement && last.DNameData == name) {
-                impl->DQueue.back().DType = SXMLEntity::EType::CompleteElement; 
+                last.DType = SXMLEntity::EType::CompleteElement;
+                impl->LimitQueue(impl->DMaxQueued);
                 return;
             }
         }
 
-        SXMLEntity ent;
-        ent.DType = SXMLEntity::EType::EndElement;
-        ent.DNameData = name;
-        impl->DQueue.push_back(ent);
+        SXMLEntity &ent = impl->PushEntity(SXMLEntity::EType::EndElement);
+        ent.DNameData.assign(name);
+        impl->LimitQueue(impl->DMaxQueued);
     }
 
     static void CharacterDataHandler(void *userdata, const XML_Char *s, int len) {
         auto *impl = static_cast<SImplementation *>(userdata);
         if (s && len > 0) {
             impl->DCharBuffer.append(s, s + len);
+            if (impl->DCharDataLimit) {
+                impl->SplitCharData();
+            }
         }
     }
 
+    // Queues full-size pieces of the buffered text, cut between UTF-8
+    // sequences, and keeps the rest buffered for the next callback
+    void SplitCharData() {
+        std::size_t start = 0;
+        while (DCharBuffer.size() - start >= DCharDataLimit) {
+            std::size_t cut = start + DCharDataLimit;
+            while (cut > start && (DCharBuffer[cut] & 0xC0) == 0x80) {
+                cut--;
+            }
+            if (cut == start) {
+                // limit smaller than one character, cut after it instead
+                cut = start + DCharDataLimit;
+                while (cut < DCharBuffer.size() && (DCharBuffer[cut] & 0xC0) == 0x80) {
+                    cut++;
+                }
+            }
+            SXMLEntity &ent = PushEntity(SXMLEntity::EType::CharData);
+            ent.DNameData.assign(DCharBuffer, start, cut - start);
+            start = cut;
+        }
+        DCharBuffer.erase(0, start);
+        // pieces can't be part of a CompleteElement, so pausing is fine here
+        LimitQueue(DMaxQueued);
+    }
+
     void FlushCharDataToQueue() {
         if (!DCharBuffer.empty()) {
-            SXMLEntity ent;
-            ent.DType = SXMLEntity::EType::CharData;
-            ent.DNameData = DCharBuffer;
-            DQueue.push_back(ent);
+            SXMLEntity &ent = PushEntity(SXMLEntity::EType::CharData);
+            // trade buffers instead of copying the text
+            std::swap(ent.DNameData, DCharBuffer);
             DCharBuffer.clear();
         }
     }
@@ -94,49 +232,74 @@ struct CXMLReader::SImplementation {
             return false;
         }
 
-        std::vector<char> buf;
-        bool got = DSource->Read(buf, 4096);
-
-        if (got) {
-            int ok = XML_Parse(DParser, buf.data(), static_cast<int>(buf.size()), 0);
-            return ok != 0;
+        XML_Status status;
+        if (DSuspended) {
+            // finish the input expat already has before feeding it more
+            DSuspended = false;
+            status = XML_ResumeParser(DParser);
         } else {
-            // If bytes read: finalize parsing
-            int ok = XML_Parse(DParser, "", 0, 1);
+            // Copy the next chunk straight into expat's own buffer, so
+            // XML_Parse doesn't have to copy it again
+            void *buffer = XML_GetBuffer(DParser, static_cast<int>(DChunkSize));
+            if (!buffer) {
+                return false;
+            }
+            std::size_t filled = 0;
+            const char *data;
+            std::size_t length;
+            // one window per chunk, it may have been a whole read() and
+            // asking for the next could block
+            if (DSource->Window(data, length)) {
+                filled = std::min(length, DChunkSize);
+                std::copy(data, data + filled, static_cast<char *>(buffer));
+                DSource->Consume(filled);
+            }
+            // No bytes left: finalize parsing
+            DFinalSubmitted = !filled;
+            status = XML_ParseBuffer(DParser, static_cast<int>(filled), DFinalSubmitted);
+        }
+
+        if (status == XML_STATUS_SUSPENDED) {
+            DSuspended = true;
+            return true;
+        }
+        if (DFinalSubmitted) {
             DParsedFinal = true;
 
-            // Flush any remaining char data 
+            // Flush any remaining char data
             FlushCharDataToQueue();
-
-            return ok != 0;
         }
+        return status != XML_STATUS_ERROR;
     }
 };
 
-CXMLReader::CXMLReader(std::shared_ptr<CDataSource> src)
-    : DImplementation(std::make_unique<SImplementation>(src)) {}
+CXMLReader::CXMLReader(std::shared_ptr<CDataSource> src, std::size_t chunksize, std::size_t maxqueued)
+    : DImplementation(std::make_unique<SImplementation>(src, chunksize, maxqueued)) {}
 
 CXMLReader::~CXMLReader() = default;
 
+void CXMLReader::SetCharDataLimit(std::size_t limit) {
+    DImplementation->DCharDataLimit = limit;
+}
+
 bool CXMLReader::End() const {
-    // Finished if the source is at EOF and nothing queued
-    return DImplementation->DSource->End() && DImplementation->DQueue.empty()
-           && DImplementation->DCharBuffer.empty();
+    // Finished if the source is at EOF and nothing queued or left in expat
+    return DImplementation->DSource->End() && !DImplementation->DQueueCount
+           && DImplementation->DCharBuffer.empty() && !DImplementation->DSuspended;
 }
 
 
 bool CXMLReader::ReadEntity(SXMLEntity &entity, bool skipcdata) {
     while (true) {
         // REturn if somehting queued
-        while (!DImplementation->DQueue.empty()) {
-            SXMLEntity next = DImplementation->DQueue.front();
-            DImplementation->DQueue.pop_front();
-
-            if (skipcdata && next.DType == SXMLEntity::EType::CharData) {
+        while (DImplementation->DQueueCount) {
+            if (skipcdata && DImplementation->QueueSlot(0).DType == SXMLEntity::EType::CharData) {
+                DImplementation->PopEntity(nullptr);
                 continue;
             }
 
-            entity = next;
+            DImplementation->PopEntity(&entity);
+            DImplementation->DLastWasStart = entity.DType == SXMLEntity::EType::StartElement;
             return true;
         }
 
@@ -148,7 +311,7 @@ bool CXMLReader::ReadEntity(SXMLEntity &entity, bool skipcdata) {
         // Otherwise parse more input into the queue
         if (!DImplementation->ParseMore()) {
             // Parse error or nothing more to parse
-            if (DImplementation->DParsedFinal && DImplementation->DQueue.empty()) {
+            if (DImplementation->DParsedFinal && !DImplementation->DQueueCount) {
                 return false;
             }
             // Return false if a parse error occurred
@@ -156,3 +319,32 @@ bool CXMLReader::ReadEntity(SXMLEntity &entity, bool skipcdata) {
         }
     }
 }
+
+bool CXMLReader::SkipElement() {
+    auto &Impl = *DImplementation;
+    if (!Impl.DLastWasStart) {
+        return false;
+    }
+    Impl.DLastWasStart = false;
+
+    // whatever is already queued is dropped first, keeping count of depth
+    std::size_t depth = 1;
+    while (Impl.DQueueCount) {
+        SXMLEntity::EType type = Impl.QueueSlot(0).DType;
+        Impl.PopEntity(nullptr);
+        if (type == SXMLEntity::EType::StartElement) {
+            depth++;
+        } else if (type == SXMLEntity::EType::EndElement && !--depth) {
+            return true;
+        }
+    }
+
+    // the rest of the subtree is discarded inside the callbacks
+    Impl.BeginSkip(depth);
+    while (Impl.DSkipDepth) {
+        if (!Impl.ParseMore()) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -1,6 +1,7 @@
 #include "XMLWriter.h"
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 static std::string EscapeText(const std::string &s) {
@@ -34,8 +35,7 @@ struct CXMLWriter::SImplementation {
     SImplementation(std::shared_ptr<CDataSink> sink) : DSink(sink) {}
 
     bool WriteString(const std::string &s) {
-        std::vector<char> buf(s.begin(), s.end());
-        return DSink->Write(buf);
+        return DSink->Write(std::string_view(s));
     }
 };
 
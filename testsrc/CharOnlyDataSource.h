@@ -0,0 +1,19 @@
+#ifndef CHARONLYDATASOURCE_H
+#define CHARONLYDATASOURCE_H
+
+#include "StringDataSource.h"
+
+// Source that only implements the required methods, so readers go through
+// the default Window/Consume fallback of CDataSource
+class CCharOnlyDataSource : public CDataSource{
+    private:
+        CStringDataSource DSource;
+    public:
+        CCharOnlyDataSource(const std::string &str) : DSource(str){}
+        bool End() const noexcept override{ return DSource.End(); }
+        bool Get(char &ch) noexcept override{ return DSource.Get(ch); }
+        bool Peek(char &ch) noexcept override{ return DSource.Peek(ch); }
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override{ return DSource.Read(buf, count); }
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "DSVIndex.h"
+#include "DSVReader.h"
+#include "FileDataSource.h"
+#include "MmapDataSource.h"
+#include "StringDataSink.h"
+#include "StringDataSource.h"
+
+#include <fstream>
+
+static std::string TempFilename(const std::string &name){
+    return testing::TempDir() + "dsvindextest_" + name;
+}
+
+// rows "0,a" .. "n-1,a", every fifth one quoted with a newline inside
+static std::string MakeInput(size_t rows){
+    std::string Input;
+    for(size_t Row = 0; Row < rows; Row++){
+        Input += std::to_string(Row) + (Row % 5 ? ",a\n" : ",\"x\ny\"\n");
+    }
+    return Input;
+}
+
+TEST(DSVReader, TellAndSeekOffset){
+    auto Source = std::make_shared<CStringDataSource>("a,b\n\"c\nd\",e\nf\n");
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    EXPECT_EQ(Reader.Tell(), (size_t)0);
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Reader.Tell(), (size_t)4);
+    EXPECT_TRUE(Reader.SkipRow());
+    size_t Checkpoint = Reader.Tell();
+    EXPECT_EQ(Checkpoint, (size_t)12);
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_TRUE(Reader.End());
+
+    EXPECT_TRUE(Reader.SeekOffset(4));
+    EXPECT_FALSE(Reader.End());
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"c\nd", "e"}));
+    EXPECT_TRUE(Reader.SeekOffset(Checkpoint));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"f"}));
+    EXPECT_FALSE(Reader.SeekOffset(100));
+}
+
+TEST(DSVReader, SeekUnsupported){
+    // the base class default can't seek
+    class CNoSeekSource : public CDataSource{
+        public:
+            CStringDataSource DInner{"a\nb\n"};
+            bool End() const noexcept override{ return DInner.End(); }
+            bool Get(char &ch) noexcept override{ return DInner.Get(ch); }
+            bool Peek(char &ch) noexcept override{ return DInner.Peek(ch); }
+            bool Read(std::vector<char> &buf, std::size_t count) noexcept override{ return DInner.Read(buf, count); }
+    };
+    auto Source = std::make_shared<CNoSeekSource>();
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_FALSE(Reader.SeekOffset(0));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"b"}));
+}
+
+TEST(DSVIndex, BuildAndSeekRow){
+    std::string Input = MakeInput(100);
+    auto Source = std::make_shared<CStringDataSource>(Input);
+    CDSVReader Reader(Source, ',');
+    CDSVIndex Index(8);
+    Index.Build(Reader);
+    EXPECT_EQ(Index.RowCount(), (size_t)100);
+    EXPECT_EQ(Index.Stride(), (size_t)8);
+
+    size_t IndexedRow, Offset;
+    EXPECT_TRUE(Index.Lookup(19, IndexedRow, Offset));
+    EXPECT_EQ(IndexedRow, (size_t)16);
+    EXPECT_EQ(Input.compare(Offset, 3, "16,"), 0);
+    EXPECT_FALSE(Index.Lookup(100, IndexedRow, Offset));
+
+    std::vector<std::string> Row;
+    for(size_t Target : {99, 0, 45, 8, 7}){
+        EXPECT_TRUE(Reader.SeekRow(Index, Target));
+        EXPECT_TRUE(Reader.ReadRow(Row));
+        EXPECT_EQ(Row[0], std::to_string(Target));
+        EXPECT_EQ(Row[1], Target % 5 ? "a" : "x\ny");
+    }
+    EXPECT_FALSE(Reader.SeekRow(Index, 100));
+}
+
+TEST(DSVIndex, SaveAndLoad){
+    auto Source = std::make_shared<CStringDataSource>(MakeInput(1000));
+    CDSVReader Reader(Source, ',');
+    CDSVIndex Index(10);
+    Index.Build(Reader);
+
+    auto Sink = std::make_shared<CStringDataSink>();
+    EXPECT_TRUE(Index.Save(Sink));
+    // 100 offsets about 70 bytes apart fit in one byte each
+    EXPECT_LT(Sink->String().size(), (size_t)120);
+
+    CDSVIndex Loaded;
+    EXPECT_TRUE(Loaded.Load(std::make_shared<CStringDataSource>(Sink->String())));
+    EXPECT_EQ(Loaded.Stride(), (size_t)10);
+    EXPECT_EQ(Loaded.RowCount(), (size_t)1000);
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.SeekRow(Loaded, 777));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row[0], "777");
+
+    EXPECT_FALSE(Loaded.Load(std::make_shared<CStringDataSource>("nope")));
+    EXPECT_FALSE(Loaded.Load(std::make_shared<CStringDataSource>(Sink->String().substr(0, 20))));
+    EXPECT_EQ(Loaded.RowCount(), (size_t)1000);
+}
+
+TEST(DSVIndex, FileAndMmapSources){
+    std::string Filename = TempFilename("rows.csv");
+    {
+        std::ofstream Output(Filename, std::ios::binary);
+        Output << MakeInput(5000);
+    }
+    // a small buffer makes rows straddle refills
+    auto FileSource = std::make_shared<CFileDataSource>(Filename, 64);
+    CDSVReader FileReader(FileSource, ',');
+    CDSVIndex Index(100);
+    Index.Build(FileReader);
+    EXPECT_EQ(Index.RowCount(), (size_t)5000);
+
+    auto MmapSource = std::make_shared<CMmapDataSource>(Filename);
+    CDSVReader MmapReader(MmapSource, ',');
+    std::vector<std::string> Row;
+    for(size_t Target : {4321, 12, 4999}){
+        EXPECT_TRUE(FileReader.SeekRow(Index, Target));
+        EXPECT_TRUE(FileReader.ReadRow(Row));
+        EXPECT_EQ(Row[0], std::to_string(Target));
+        EXPECT_TRUE(MmapReader.SeekRow(Index, Target));
+        EXPECT_TRUE(MmapReader.ReadRow(Row));
+        EXPECT_EQ(Row[0], std::to_string(Target));
+    }
+    std::remove(Filename.c_str());
+}
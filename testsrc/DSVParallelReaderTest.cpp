@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "DSVParallelReader.h"
+#include "DSVReader.h"
+#include "StringDataSource.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static std::string MakeInput(){
+    std::string Input;
+    for(int Index = 0; Index < 500; Index++){
+        switch(Index % 5){
+            case 0:     Input += std::to_string(Index) + ",plain,row\n"; break;
+            case 1:     Input += "\"quoted\nnewline " + std::to_string(Index) + "\",x\n"; break;
+            case 2:     Input += "\"escaped \"\"quote\"\"\n\",\"" + std::string(Index % 37, '\n') + "\"\n"; break;
+            case 3:     Input += "\n"; break;
+            default:    Input += "mid\"dle,quote\"" + std::to_string(Index) + ",\n"; break;
+        }
+    }
+    return Input + "no,trailing,newline";
+}
+
+static CDSVParallelReader::TRows ReadSequential(const std::string &input){
+    CDSVReader Reader(std::make_shared<CStringDataSource>(input), ',');
+    CDSVParallelReader::TRows Rows;
+    std::vector<std::string> Row;
+    while(Reader.ReadRow(Row)){
+        Rows.push_back(Row);
+    }
+    return Rows;
+}
+
+TEST(DSVParallelReader, MatchesSequentialOrdered){
+    std::string Input = MakeInput();
+    CDSVParallelReader::TRows Expected = ReadSequential(Input);
+
+    for(size_t ChunkSize : {1, 7, 64, 1000, 1 << 20}){
+        CDSVParallelReader Reader(std::string_view(Input), ',', true, 3, ChunkSize);
+        CDSVParallelReader::TRows Rows;
+        std::vector<std::string> Row;
+        while(!Reader.End()){
+            ASSERT_TRUE(Reader.ReadRow(Row));
+            Rows.push_back(Row);
+        }
+        EXPECT_FALSE(Reader.ReadRow(Row));
+        EXPECT_EQ(Rows, Expected);
+    }
+}
+
+TEST(DSVParallelReader, MatchesSequentialUnordered){
+    std::string Input = MakeInput();
+    CDSVParallelReader::TRows Expected = ReadSequential(Input);
+    CDSVParallelReader Reader(std::make_shared<CStringDataSource>(Input), ',', false, 4, 50);
+    CDSVParallelReader::TRows Rows, Batch;
+
+    while(Reader.ReadBatch(Batch)){
+        EXPECT_FALSE(Batch.empty());
+        Rows.insert(Rows.end(), Batch.begin(), Batch.end());
+    }
+    EXPECT_TRUE(Reader.End());
+    std::sort(Rows.begin(), Rows.end());
+    std::sort(Expected.begin(), Expected.end());
+    EXPECT_EQ(Rows, Expected);
+}
+
+TEST(DSVParallelReader, LongQuotedField){
+    // one field spans thousands of pieces, each scanned only once
+    std::string Field(50000, 'x');
+    for(size_t Index = 0; Index < Field.size(); Index += 10){
+        Field[Index] = Index % 20 ? '\n' : ',';
+    }
+    std::string Input = "a,b\n1,\"" + Field + "\",2\nc,d\n";
+    CDSVParallelReader::TRows Expected = ReadSequential(Input);
+    ASSERT_EQ(Expected.size(), (size_t)3);
+
+    CDSVParallelReader Reader(std::string_view(Input), ',', true, 4, 16);
+    CDSVParallelReader::TRows Rows, Batch;
+    while(Reader.ReadBatch(Batch)){
+        Rows.insert(Rows.end(), Batch.begin(), Batch.end());
+    }
+    EXPECT_EQ(Rows, Expected);
+}
+
+TEST(DSVParallelReader, EmptyInput){
+    CDSVParallelReader Reader(std::string_view(""), ',');
+    std::vector<std::string> Row;
+    CDSVParallelReader::TRows Batch;
+
+    EXPECT_TRUE(Reader.End());
+    EXPECT_FALSE(Reader.ReadRow(Row));
+    EXPECT_FALSE(Reader.ReadBatch(Batch));
+}
+
+TEST(DSVParallelReader, MixedReadRowAndBatch){
+    CDSVParallelReader Reader(std::string_view("a\nb\nc\n"), ',', true, 2, 1000);
+    std::vector<std::string> Row;
+    CDSVParallelReader::TRows Batch;
+
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"a"}));
+    EXPECT_TRUE(Reader.ReadBatch(Batch));
+    EXPECT_EQ(Batch, CDSVParallelReader::TRows({{"b"},{"c"}}));
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(DSVParallelReader, MmapSource){
+    std::string Input = MakeInput();
+    std::string Filename = testing::TempDir() + "dsvparallelreadertest.csv";
+    FILE *File = fopen(Filename.c_str(), "wb");
+    fwrite(Input.data(), 1, Input.size(), File);
+    fclose(File);
+
+    CDSVParallelReader Reader(std::make_shared<CMmapDataSource>(Filename), ',', true, 2, 100);
+    CDSVParallelReader::TRows Rows, Batch;
+    while(Reader.ReadBatch(Batch)){
+        Rows.insert(Rows.end(), Batch.begin(), Batch.end());
+    }
+    EXPECT_EQ(Rows, ReadSequential(Input));
+    std::remove(Filename.c_str());
+}
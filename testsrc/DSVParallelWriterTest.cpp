@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "DSVParallelWriter.h"
+#include "DSVWriter.h"
+#include "StringDataSink.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+static CDSVParallelWriter::TRows MakeBatch(size_t batch){
+    CDSVParallelWriter::TRows Rows;
+    // batches differ in size so they finish out of order
+    for(size_t Row = 0; Row < (batch * 37) % 200; Row++){
+        Rows.push_back({std::to_string(batch), std::to_string(Row), Row % 3 ? "plain" : "needs \"quoting\",\n"});
+    }
+    return Rows;
+}
+
+// Sink that holds every Write until released, or fails them all
+class CGatedDataSink : public CStringDataSink{
+    public:
+        std::mutex DMutex;
+        std::condition_variable DCondition;
+        bool DOpen = false;
+        bool DFail = false;
+
+        void Open(){
+            std::lock_guard<std::mutex> Lock(DMutex);
+            DOpen = true;
+            DCondition.notify_all();
+        }
+        using CStringDataSink::Write;
+        bool Write(const char *data, std::size_t length) noexcept override{
+            std::unique_lock<std::mutex> Lock(DMutex);
+            DCondition.wait(Lock, [this]{ return DOpen; });
+            return !DFail && CStringDataSink::Write(data, length);
+        }
+};
+
+TEST(DSVParallelWriter, MatchesSequential){
+    auto Expected = std::make_shared<CStringDataSink>();
+    {
+        CDSVWriter Writer(Expected, ',');
+        for(size_t Batch = 0; Batch < 100; Batch++){
+            for(auto &Row : MakeBatch(Batch)){
+                Writer.WriteRow(Row);
+            }
+        }
+    }
+    for(size_t Threads : {1, 4}){
+        auto Sink = std::make_shared<CStringDataSink>();
+        {
+            CDSVParallelWriter Writer(Sink, ',', false, Threads);
+            for(size_t Batch = 0; Batch < 100; Batch++){
+                EXPECT_TRUE(Writer.WriteBatch(MakeBatch(Batch)));
+            }
+        }
+        EXPECT_EQ(Sink->String(), Expected->String());
+    }
+}
+
+TEST(DSVParallelWriter, FlushAndQuoteAll){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVParallelWriter Writer(Sink, '\t', true, 2);
+    EXPECT_TRUE(Writer.WriteBatch({{"a", "b"}, {}}));
+    EXPECT_TRUE(Writer.WriteBatch({}));
+    EXPECT_TRUE(Writer.WriteBatch({{"c\"d"}}));
+    EXPECT_TRUE(Writer.Flush());
+    EXPECT_EQ(Sink->String(), "\"a\"\t\"b\"\n\n\"c\"\"d\"\n");
+}
+
+TEST(DSVParallelWriter, Backpressure){
+    auto Sink = std::make_shared<CGatedDataSink>();
+    CDSVParallelWriter Writer(Sink, ',', false, 2, 3);
+    std::atomic<size_t> Submitted{0};
+    std::thread Producer([&]{
+        for(size_t Batch = 1; Batch <= 10; Batch++){
+            Writer.WriteBatch(MakeBatch(Batch));
+            Submitted++;
+        }
+    });
+    // the sink is stuck, so only maxinflight batches can be accepted
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_LE(Submitted.load(), (size_t)3);
+    Sink->Open();
+    Producer.join();
+    EXPECT_TRUE(Writer.Flush());
+    EXPECT_EQ(Submitted.load(), (size_t)10);
+    EXPECT_EQ(Sink->String().substr(0, 4), "1,0,");
+}
+
+TEST(DSVParallelWriter, SinkFailure){
+    auto Sink = std::make_shared<CGatedDataSink>();
+    Sink->DFail = true;
+    Sink->Open();
+    CDSVParallelWriter Writer(Sink, ',', false, 2, 2);
+    EXPECT_TRUE(Writer.WriteBatch(MakeBatch(1)));
+    EXPECT_FALSE(Writer.Flush());
+    EXPECT_FALSE(Writer.WriteBatch(MakeBatch(2)));
+}
@@ -1,8 +1,21 @@
 #include <gtest/gtest.h>
 #include "DSVWriter.h"
 #include "DSVReader.h"
+#include "DSVScan.h"
 #include "StringDataSink.h"
 #include "StringDataSource.h"
+#include "CharOnlyDataSource.h"
+#include <climits>
+
+// Sink that counts how many times it was called
+class CCountingDataSink : public CStringDataSink{
+    public:
+        size_t DPutCount = 0;
+        size_t DWriteCount = 0;
+        bool Put(const char &ch) noexcept override{ DPutCount++; return CStringDataSink::Put(ch); }
+        bool Write(const char *data, std::size_t length) noexcept override{ DWriteCount++; return CStringDataSink::Write(data, length); }
+        using CStringDataSink::Write;
+};
 
 TEST(DSVWriter, SingleField){
     auto Sink = std::make_shared<CStringDataSink>();
@@ -81,6 +94,101 @@ TEST(DSVWriter, EmptyFields){
     EXPECT_EQ(Sink->String(), ",a,\n");
 }
 
+TEST(DSVWriter, OneWritePerRow){
+    auto Sink = std::make_shared<CCountingDataSink>();
+    CDSVWriter Writer(Sink, ',');
+    EXPECT_TRUE(Writer.WriteRow({"a\"b","c,d","e"}));
+    EXPECT_EQ(Sink->String(), "\"a\"\"b\",\"c,d\",e\n");
+    EXPECT_EQ(Sink->DWriteCount, (size_t)1);
+    EXPECT_EQ(Sink->DPutCount, (size_t)0);
+}
+
+TEST(DSVWriter, FlushSize){
+    auto Sink = std::make_shared<CCountingDataSink>();
+    {
+        CDSVWriter Writer(Sink, ',', false, 16);
+        EXPECT_TRUE(Writer.WriteRow({"abc","def"}));
+        EXPECT_TRUE(Writer.WriteRow({"ghi"}));
+        EXPECT_EQ(Sink->String(), "");
+        EXPECT_TRUE(Writer.WriteRow({"jkl"}));
+        EXPECT_EQ(Sink->String(), "abc,def\nghi\njkl\n");
+        EXPECT_EQ(Sink->DWriteCount, (size_t)1);
+        EXPECT_TRUE(Writer.WriteRow({"x"}));
+        EXPECT_TRUE(Writer.Flush());
+        EXPECT_EQ(Sink->DWriteCount, (size_t)2);
+        EXPECT_TRUE(Writer.Flush());
+        EXPECT_EQ(Sink->DWriteCount, (size_t)2);
+        EXPECT_TRUE(Writer.WriteRow({"y"}));
+    }
+    // the destructor writes whatever is left
+    EXPECT_EQ(Sink->String(), "abc,def\nghi\njkl\nx\ny\n");
+}
+
+TEST(DSVWriter, TakeBuffered){
+    auto Sink = std::make_shared<CCountingDataSink>();
+    {
+        CDSVWriter Writer(Sink, ',', false, SIZE_MAX);
+        EXPECT_TRUE(Writer.WriteRow({"a","b,c"}));
+        EXPECT_TRUE(Writer.WriteValues(1, 2.5));
+        EXPECT_EQ(Writer.TakeBuffered(), "a,\"b,c\"\n1,2.5\n");
+        EXPECT_EQ(Writer.TakeBuffered(), "");
+        EXPECT_TRUE(Writer.WriteRow({"d"}));
+        EXPECT_EQ(Writer.TakeBuffered(), "d\n");
+    }
+    // taken rows never reach the sink
+    EXPECT_EQ(Sink->DWriteCount, (size_t)0);
+    EXPECT_EQ(Sink->String(), "");
+}
+
+TEST(DSVWriter, LongFields){
+    // long enough for the vector scan, special characters past the first block
+    std::string Plain(100, 'a');
+    std::string Special = Plain + "\"" + Plain + "\n";
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVWriter Writer(Sink, '\t');
+    EXPECT_TRUE(Writer.WriteRow({Plain, Special, Plain + "\t"}));
+    EXPECT_EQ(Sink->String(), Plain + "\t\"" + Plain + "\"\"" + Plain + "\n\"\t\"" + Plain + "\t\"\n");
+}
+
+TEST(DSVWriter, StringViewRow){
+    auto Sink = std::make_shared<CCountingDataSink>();
+    CDSVWriter Writer(Sink, ',');
+    std::vector<std::string_view> Row = {"a", "b,c", ""};
+    EXPECT_TRUE(Writer.WriteRow(Row));
+    std::string_view Fixed[] = {"x", "y\"z"};
+    EXPECT_TRUE(Writer.WriteRow(Fixed));
+    EXPECT_TRUE(Writer.WriteRow(std::span<const std::string_view>()));
+    EXPECT_EQ(Sink->String(), "a,\"b,c\",\nx,\"y\"\"z\"\n\n");
+    EXPECT_EQ(Sink->DWriteCount, (size_t)3);
+}
+
+TEST(DSVWriter, WriteValues){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVWriter Writer(Sink, ',');
+    std::string Name = "n,1";
+    EXPECT_TRUE(Writer.WriteValues(-42, 7u, 2.5, 0.1f, true, "text", Name, std::string_view("v"), 'c'));
+    EXPECT_TRUE(Writer.WriteValues(std::int64_t(-9223372036854775807LL - 1), std::uint64_t(18446744073709551615ULL), 1e300));
+    EXPECT_TRUE(Writer.WriteValues());
+    EXPECT_EQ(Sink->String(), "-42,7,2.5,0.1,true,text,\"n,1\",v,c\n"
+        "-9223372036854775808,18446744073709551615,1e+300\n\n");
+}
+
+TEST(DSVWriter, WriteFieldStreaming){
+    auto Sink = std::make_shared<CStringDataSink>();
+    // a digit delimiter forces numbers to be quoted
+    CDSVWriter Writer(Sink, '1');
+    for(int Value : {10, 2}){
+        Writer.WriteField(Value);
+    }
+    EXPECT_TRUE(Writer.EndRow());
+    EXPECT_EQ(Sink->String(), "\"10\"12\n");
+
+    auto QuoteSink = std::make_shared<CStringDataSink>();
+    CDSVWriter QuoteWriter(QuoteSink, ',', true);
+    EXPECT_TRUE(QuoteWriter.WriteValues(1, 2.0));
+    EXPECT_EQ(QuoteSink->String(), "\"1\",\"2\"\n");
+}
+
 TEST(DSVReader, SingleField){
     auto Source = std::make_shared<CStringDataSource>("hello\n");
     CDSVReader Reader(Source, ',');
@@ -195,3 +303,412 @@ TEST(DSVReader, QuoteDelimiter){
     EXPECT_TRUE(Reader.ReadRow(Row));
     EXPECT_EQ(Row, std::vector<std::string>({"a","b"}));
 }
+
+TEST(DSVReader, CharOnlySource){
+    auto Source = std::make_shared<CCharOnlyDataSource>("a,\"b\"\"c\",d\n\n\"e\nf\"");
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"a","b\"c","d"}));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row.size(), (size_t)0);
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"e\nf"}));
+    EXPECT_TRUE(Reader.End());
+    EXPECT_FALSE(Reader.ReadRow(Row));
+}
+
+TEST(DSVReader, SourcePositionAfterReader){
+    auto Source = std::make_shared<CStringDataSource>("a,b\nc,d\n");
+    {
+        CDSVReader Reader(Source, ',');
+        std::vector<std::string> Row;
+        EXPECT_TRUE(Reader.ReadRow(Row));
+    }
+    char TempCh;
+    EXPECT_TRUE(Source->Peek(TempCh));
+    EXPECT_EQ(TempCh, 'c');
+}
+
+TEST(DSVScan, FindSpecial){
+    // every length and special position around the 16 and 32 byte blocks
+    for(size_t length = 0; length < 80; length++){
+        for(size_t pos = 0; pos <= length; pos++){
+            for(char special : {',', '"', '\n'}){
+                std::string text(length, 'x');
+                if(pos < length) text[pos] = special;
+                const char *found = DSVScan::FindSpecial(text.data(), text.data() + length, ',');
+                EXPECT_EQ(found - text.data(), (ptrdiff_t)pos);
+            }
+        }
+    }
+    std::string tabs = "a,b\tc";
+    EXPECT_EQ(DSVScan::FindSpecial(tabs.data(), tabs.data() + tabs.size(), '\t') - tabs.data(), 3);
+}
+
+TEST(DSVScan, FindQuote){
+    std::string text(100, 'x');
+    EXPECT_EQ(DSVScan::FindQuote(text.data(), text.data() + text.size()), text.data() + text.size());
+    text[70] = '"';
+    text[90] = '"';
+    EXPECT_EQ(DSVScan::FindQuote(text.data(), text.data() + text.size()), text.data() + 70);
+    EXPECT_EQ(DSVScan::FindQuote(text.data(), text.data()), text.data());
+}
+
+TEST(DSVReader, LongFields){
+    std::string a(37, 'a'), b(70, 'b'), c(100, 'c');
+    std::string quoted = std::string(40, 'q') + "\"\"" + std::string(20, ',') + "\n" + std::string(30, 'r');
+    std::string input = a + "," + b + ",\"" + std::string(40, 'q') + "\"\"\"\"" + std::string(20, ',') + "\n" + std::string(30, 'r') + "\"\n" + c + "\n";
+    auto Source = std::make_shared<CStringDataSource>(input);
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({a, b, quoted}));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({c}));
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(DSVReader, ReadRowView){
+    auto Source = std::make_shared<CStringDataSource>("a,\"b,c\",\"d\"\"e\"\n\n,x,\n\"\"\nlast");
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string_view> Row;
+    EXPECT_TRUE(Reader.ReadRowView(Row));
+    EXPECT_EQ(Row, std::vector<std::string_view>({"a","b,c","d\"e"}));
+    EXPECT_TRUE(Reader.ReadRowView(Row));
+    EXPECT_EQ(Row.size(), (size_t)0);
+    EXPECT_TRUE(Reader.ReadRowView(Row));
+    EXPECT_EQ(Row, std::vector<std::string_view>({"","x",""}));
+    EXPECT_TRUE(Reader.ReadRowView(Row));
+    EXPECT_EQ(Row, std::vector<std::string_view>({""}));
+    EXPECT_TRUE(Reader.ReadRowView(Row));
+    EXPECT_EQ(Row, std::vector<std::string_view>({"last"}));
+    EXPECT_TRUE(Reader.End());
+    EXPECT_FALSE(Reader.ReadRowView(Row));
+}
+
+TEST(DSVReader, ReadRowViewPointsIntoSource){
+    std::string Input = "abc,def\nghi\n";
+    auto Source = std::make_shared<CStringDataSource>(std::string_view(Input));
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string_view> Row;
+    EXPECT_TRUE(Reader.ReadRowView(Row));
+    ASSERT_EQ(Row.size(), (size_t)2);
+    EXPECT_EQ(Row[0].data(), Input.data());
+    EXPECT_EQ(Row[1].data(), Input.data() + 4);
+}
+
+TEST(DSVReader, ReadRowViewMatchesReadRow){
+    // tiny windows make rows straddle window boundaries everywhere
+    std::string Input = "ab,\"c\"\"d\",efg\n\"h\ni\",,\"\"\"\"\nj\n\nk,\"l,m\"";
+    auto ViewSource = std::make_shared<CCharOnlyDataSource>(Input);
+    auto RowSource = std::make_shared<CStringDataSource>(Input);
+    CDSVReader ViewReader(ViewSource, ',');
+    CDSVReader RowReader(RowSource, ',');
+    std::vector<std::string_view> ViewRow;
+    std::vector<std::string> Row;
+    while(RowReader.ReadRow(Row)){
+        ASSERT_TRUE(ViewReader.ReadRowView(ViewRow));
+        EXPECT_EQ(std::vector<std::string>(ViewRow.begin(), ViewRow.end()), Row);
+    }
+    EXPECT_FALSE(ViewReader.ReadRowView(ViewRow));
+    EXPECT_TRUE(ViewReader.End());
+}
+
+TEST(DSVReader, SelectColumns){
+    auto Source = std::make_shared<CStringDataSource>("a,\"b,\"\"x\",c,d\n\ne,f\n,,\"g\nh\",i\n");
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    Reader.SelectColumns({2, 0});
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"c","a"}));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row.size(), (size_t)0);
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"","e"}));
+    Reader.SelectColumns({});
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"","","g\nh","i"}));
+}
+
+TEST(DSVReader, SelectColumnsRepeated){
+    auto Source = std::make_shared<CStringDataSource>("a,b,c\nd,e,f\n");
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.SelectColumns({2, 1}));
+    // a repeated column is rejected and the old selection stays
+    EXPECT_FALSE(Reader.SelectColumns({0, 0}));
+    EXPECT_FALSE(Reader.SelectColumns({1, 0, 1}));
+    // so is a column too large to index
+    EXPECT_FALSE(Reader.SelectColumns({0, SIZE_MAX}));
+    EXPECT_FALSE(Reader.SelectColumns({std::size_t(INT_MAX)}));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"c","b"}));
+
+    auto HeaderSource = std::make_shared<CStringDataSource>("x,y\n1,2\n");
+    CDSVReader HeaderReader(HeaderSource, ',');
+    EXPECT_FALSE(HeaderReader.SelectHeaderColumns({"y", "y"}));
+    EXPECT_TRUE(HeaderReader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"1","2"}));
+
+    // missing names don't collide with each other
+    auto MissingSource = std::make_shared<CStringDataSource>("x,y\n1,2\n");
+    CDSVReader MissingReader(MissingSource, ',');
+    EXPECT_FALSE(MissingReader.SelectHeaderColumns({"p", "y", "q"}));
+    EXPECT_TRUE(MissingReader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"","2",""}));
+}
+
+TEST(DSVReader, SelectColumnsView){
+    auto Source = std::make_shared<CCharOnlyDataSource>("a,\"b\"\"\",c\nd,e,\"f\"\"\"\n");
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string_view> Row;
+    Reader.SelectColumns({1, 2, 5});
+    EXPECT_TRUE(Reader.ReadRowView(Row));
+    EXPECT_EQ(Row, std::vector<std::string_view>({"b\"","c",""}));
+    EXPECT_TRUE(Reader.ReadRowView(Row));
+    EXPECT_EQ(Row, std::vector<std::string_view>({"e","f\"",""}));
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(DSVReader, SelectHeaderColumns){
+    auto Source = std::make_shared<CStringDataSource>("id,name,\"zip code\"\n1,ann,95616\n2,bob,95618\n");
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.SelectHeaderColumns({"zip code","id"}));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"95616","1"}));
+
+    auto Missing = std::make_shared<CStringDataSource>("id,name\n1,ann\n");
+    CDSVReader MissingReader(Missing, ',');
+    EXPECT_FALSE(MissingReader.SelectHeaderColumns({"name","age"}));
+    EXPECT_TRUE(MissingReader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"ann",""}));
+
+    auto Empty = std::make_shared<CStringDataSource>("");
+    CDSVReader EmptyReader(Empty, ',');
+    EXPECT_FALSE(EmptyReader.SelectHeaderColumns({"id"}));
+}
+
+static std::vector<std::string> BatchColumn(const SDSVColumnBatch &batch, size_t column){
+    std::vector<std::string> Values;
+    for(size_t Row = 0; Row < batch.DRowCount; Row++){
+        Values.emplace_back(batch.DColumns[column].Value(Row));
+    }
+    return Values;
+}
+
+TEST(DSVReader, ReadRows){
+    auto Source = std::make_shared<CCharOnlyDataSource>("a,\"b\"\"c\"\nd\n\ne,f,\"g\nh\"\ni,j\n");
+    CDSVReader Reader(Source, ',');
+    SDSVColumnBatch Batch;
+    EXPECT_EQ(Reader.ReadRows(Batch, 3), (size_t)3);
+    ASSERT_EQ(Batch.DColumns.size(), (size_t)2);
+    EXPECT_EQ(BatchColumn(Batch, 0), std::vector<std::string>({"a","d",""}));
+    EXPECT_EQ(BatchColumn(Batch, 1), std::vector<std::string>({"b\"c","",""}));
+
+    EXPECT_EQ(Reader.ReadRows(Batch, 3), (size_t)2);
+    ASSERT_EQ(Batch.DColumns.size(), (size_t)3);
+    EXPECT_EQ(BatchColumn(Batch, 0), std::vector<std::string>({"e","i"}));
+    EXPECT_EQ(BatchColumn(Batch, 1), std::vector<std::string>({"f","j"}));
+    EXPECT_EQ(BatchColumn(Batch, 2), std::vector<std::string>({"g\nh",""}));
+    EXPECT_TRUE(Reader.End());
+    EXPECT_EQ(Reader.ReadRows(Batch, 3), (size_t)0);
+    EXPECT_EQ(Batch.DRowCount, (size_t)0);
+}
+
+TEST(DSVReader, ReadRowsReusesBuffers){
+    std::string Input;
+    for(int Index = 0; Index < 100; Index++){
+        Input += std::to_string(Index) + ",x,\"y\"\n";
+    }
+    auto Source = std::make_shared<CStringDataSource>(Input);
+    CDSVReader Reader(Source, ',');
+    Reader.SelectColumns({2, 0});
+    SDSVColumnBatch Batch;
+    EXPECT_EQ(Reader.ReadRows(Batch, 50), (size_t)50);
+    const char *Data = Batch.DColumns[1].DData.data();
+    EXPECT_EQ(Reader.ReadRows(Batch, 50), (size_t)50);
+    // second batch fits in what the first one allocated
+    EXPECT_EQ(Batch.DColumns[1].DData.data(), Data);
+    ASSERT_EQ(Batch.DColumns.size(), (size_t)2);
+    EXPECT_EQ(Batch.DColumns[0].Value(0), "y");
+    EXPECT_EQ(Batch.DColumns[1].Value(0), "50");
+    EXPECT_EQ(Batch.DColumns[1].Value(49), "99");
+}
+
+TEST(DSVSchema, Parsers){
+    std::int64_t Int;
+    double Double;
+    bool Bool;
+    EXPECT_TRUE(DSVSchema::ParseInt64("-42", Int));
+    EXPECT_EQ(Int, -42);
+    EXPECT_FALSE(DSVSchema::ParseInt64("42x", Int));
+    EXPECT_FALSE(DSVSchema::ParseInt64("", Int));
+    EXPECT_FALSE(DSVSchema::ParseInt64("99999999999999999999", Int));
+    EXPECT_TRUE(DSVSchema::ParseDouble("2.5e3", Double));
+    EXPECT_EQ(Double, 2500.0);
+    EXPECT_FALSE(DSVSchema::ParseDouble("2.5.3", Double));
+    EXPECT_TRUE(DSVSchema::ParseBool("TRUE", Bool));
+    EXPECT_TRUE(Bool);
+    EXPECT_TRUE(DSVSchema::ParseBool("0", Bool));
+    EXPECT_FALSE(Bool);
+    EXPECT_FALSE(DSVSchema::ParseBool("yes", Bool));
+    EXPECT_TRUE(DSVSchema::ParseDate("1970-01-01", Int));
+    EXPECT_EQ(Int, 0);
+    EXPECT_TRUE(DSVSchema::ParseDate("2000-03-01", Int));
+    EXPECT_EQ(Int, 11017);
+    EXPECT_TRUE(DSVSchema::ParseDate("1969-12-31", Int));
+    EXPECT_EQ(Int, -1);
+    EXPECT_FALSE(DSVSchema::ParseDate("2023-02-29", Int));
+    EXPECT_FALSE(DSVSchema::ParseDate("2023-1-01", Int));
+    EXPECT_EQ(DSVSchema::DetectType("false"), EDSVType::Bool);
+    EXPECT_EQ(DSVSchema::DetectType("1"), EDSVType::Int64);
+    EXPECT_EQ(DSVSchema::DetectType("1.5"), EDSVType::Double);
+    EXPECT_EQ(DSVSchema::DetectType("2024-02-29"), EDSVType::Date);
+    EXPECT_EQ(DSVSchema::DetectType("abc"), EDSVType::String);
+}
+
+TEST(DSVReader, ReadTypedRows){
+    auto Source = std::make_shared<CCharOnlyDataSource>("1,2.5,true,\"a\"\"b\",2024-01-02\nx,,false,,\n-3,1e2\n");
+    CDSVReader Reader(Source, ',');
+    SDSVTypedBatch Batch;
+    TDSVSchema Schema = {EDSVType::Int64, EDSVType::Double, EDSVType::Bool, EDSVType::String, EDSVType::Date};
+    EXPECT_EQ(Reader.ReadTypedRows(Schema, Batch, 10), (size_t)3);
+    ASSERT_EQ(Batch.DColumns.size(), (size_t)5);
+    EXPECT_EQ(Batch.DColumns[0].DInts, std::vector<std::int64_t>({1, 0, -3}));
+    EXPECT_EQ(Batch.DColumns[0].DValid, std::vector<std::uint8_t>({1, 0, 1}));
+    EXPECT_EQ(Batch.DColumns[1].DDoubles, std::vector<double>({2.5, 0.0, 100.0}));
+    EXPECT_EQ(Batch.DColumns[1].DValid, std::vector<std::uint8_t>({1, 0, 1}));
+    EXPECT_EQ(Batch.DColumns[2].DBools, std::vector<std::uint8_t>({1, 0, 0}));
+    EXPECT_EQ(Batch.DColumns[2].DValid, std::vector<std::uint8_t>({1, 1, 0}));
+    EXPECT_EQ(Batch.DColumns[3].DStrings.Value(0), "a\"b");
+    EXPECT_EQ(Batch.DColumns[3].DStrings.Value(1), "");
+    EXPECT_EQ(Batch.DColumns[4].DInts[0], 19724);
+    // only the unparsable "x" is an error, empty and missing values are nulls
+    ASSERT_EQ(Batch.DErrors.size(), (size_t)1);
+    EXPECT_EQ(Batch.DErrors[0].DRow, (size_t)1);
+    EXPECT_EQ(Batch.DErrors[0].DColumn, (size_t)0);
+}
+
+TEST(DSVReader, InferSchema){
+    auto Source = std::make_shared<CStringDataSource>("1,2,x,true,2024-01-01,\n3,4.5,y,False,2024-01-02,\n5,6,7,true,2024-01-03,\n");
+    CDSVReader Reader(Source, ',');
+    TDSVSchema Schema = Reader.InferSchema();
+    EXPECT_EQ(Schema, TDSVSchema({EDSVType::Int64, EDSVType::Double, EDSVType::String, EDSVType::Bool, EDSVType::Date, EDSVType::String}));
+    EXPECT_EQ(Reader.InferSchema(1)[1], EDSVType::Int64);
+
+    // nothing was consumed
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row[0], "1");
+    SDSVTypedBatch Batch;
+    EXPECT_EQ(Reader.ReadTypedRows(Schema, Batch, 10), (size_t)2);
+    EXPECT_EQ(Batch.DColumns[1].DDoubles, std::vector<double>({4.5, 6.0}));
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(DSVReader, InferSchemaLastRow){
+    // the last row of the buffer counts once it has its newline
+    EXPECT_EQ(CDSVReader(std::make_shared<CStringDataSource>("1,2.5\n"), ',').InferSchema(), TDSVSchema({EDSVType::Int64, EDSVType::Double}));
+    EXPECT_EQ(CDSVReader(std::make_shared<CStringDataSource>("1,2\n3,4.5\n"), ',').InferSchema(), TDSVSchema({EDSVType::Int64, EDSVType::Double}));
+    EXPECT_EQ(CDSVReader(std::make_shared<CStringDataSource>("1,2.5\nx,3\n"), ',').InferSchema(), TDSVSchema({EDSVType::String, EDSVType::Double}));
+    EXPECT_EQ(CDSVReader(std::make_shared<CStringDataSource>("1,2\n3,4\n"), ',').InferSchema(1), TDSVSchema({EDSVType::Int64, EDSVType::Int64}));
+    // and so does one without a newline at the end of the input
+    EXPECT_EQ(CDSVReader(std::make_shared<CStringDataSource>("1,2\n3,4.5"), ',').InferSchema(), TDSVSchema({EDSVType::Int64, EDSVType::Double}));
+    EXPECT_EQ(CDSVReader(std::make_shared<CStringDataSource>("1,x"), ',').InferSchema(), TDSVSchema({EDSVType::Int64, EDSVType::String}));
+}
+
+// Source whose windows are at most three bytes long
+class CTinyWindowDataSource : public CStringDataSource{
+    public:
+        using CStringDataSource::CStringDataSource;
+        bool Window(const char *&data, std::size_t &length) noexcept override{
+            bool Result = CStringDataSource::Window(data, length);
+            length = std::min<std::size_t>(length, 3);
+            return Result;
+        }
+};
+
+TEST(DSVReader, InferSchemaSmallWindows){
+    // rows longer than the window are pulled in and still read afterwards
+    auto Source = std::make_shared<CTinyWindowDataSource>("id,score\n1,2.5\n2,3\n3,\"4\"");
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Reader.InferSchema(), TDSVSchema({EDSVType::Int64, EDSVType::Double}));
+    EXPECT_EQ(Reader.InferSchema(1), TDSVSchema({EDSVType::Int64, EDSVType::Double}));
+    EXPECT_EQ(Reader.Tell(), (size_t)9);
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"1","2.5"}));
+    EXPECT_EQ(Reader.Tell(), (size_t)15);
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"2","3"}));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"3","4"}));
+    EXPECT_FALSE(Reader.ReadRow(Row));
+    EXPECT_TRUE(Reader.End());
+
+    // views of fields that straddle the copied input and the source
+    CDSVReader ViewReader(std::make_shared<CTinyWindowDataSource>("abc,\"d\"\"e\"\nfghij,k\nl"), ',');
+    EXPECT_EQ(ViewReader.InferSchema(2), TDSVSchema({EDSVType::String, EDSVType::String}));
+    std::vector<std::string_view> View;
+    EXPECT_TRUE(ViewReader.ReadRowView(View));
+    EXPECT_EQ(View, std::vector<std::string_view>({"abc","d\"e"}));
+    EXPECT_TRUE(ViewReader.ReadRowView(View));
+    EXPECT_EQ(View, std::vector<std::string_view>({"fghij","k"}));
+    EXPECT_TRUE(ViewReader.ReadRowView(View));
+    EXPECT_EQ(View, std::vector<std::string_view>({"l"}));
+
+    // sources without windows of their own are sampled too
+    EXPECT_EQ(CDSVReader(std::make_shared<CCharOnlyDataSource>("1,a\n2,b"), ',').InferSchema(), TDSVSchema({EDSVType::Int64, EDSVType::String}));
+}
+
+TEST(DSVReader, InferSchemaNonFinite){
+    // nan and inf words are text, not doubles
+    EXPECT_EQ(CDSVReader(std::make_shared<CStringDataSource>("Nan,INF,-infinity,1.5\n"), ',').InferSchema(), TDSVSchema({EDSVType::String, EDSVType::String, EDSVType::String, EDSVType::Double}));
+    EXPECT_EQ(CDSVReader(std::make_shared<CStringDataSource>("1.5\nnan\n"), ',').InferSchema(), TDSVSchema({EDSVType::String}));
+
+    // and are errors when read as doubles
+    CDSVReader Reader(std::make_shared<CStringDataSource>("inf\n2.5\n"), ',');
+    SDSVTypedBatch Batch;
+    EXPECT_EQ(Reader.ReadTypedRows({EDSVType::Double}, Batch, 10), (size_t)2);
+    EXPECT_EQ(Batch.DColumns[0].DValid, std::vector<std::uint8_t>({0, 1}));
+    ASSERT_EQ(Batch.DErrors.size(), (size_t)1);
+    EXPECT_EQ(Batch.DErrors[0].DRow, (size_t)0);
+}
+
+TEST(DSVReader, EncodeColumns){
+    auto Source = std::make_shared<CCharOnlyDataSource>("1,us,open\n2,\"ca\",closed\n3,us,open\n4\n5,ca,\"op\"\"en\"\n");
+    CDSVReader Reader(Source, ',');
+    Reader.EncodeColumns({1, 2});
+    SDSVColumnBatch Batch;
+    EXPECT_EQ(Reader.ReadRows(Batch, 3), (size_t)3);
+    ASSERT_EQ(Batch.DColumns.size(), (size_t)3);
+    EXPECT_TRUE(Batch.DColumns[1].DData.empty());
+    EXPECT_EQ(Batch.DColumns[1].DCodes, std::vector<std::uint32_t>({0, 1, 0}));
+    EXPECT_EQ(Batch.DColumns[2].DCodes, std::vector<std::uint32_t>({0, 1, 0}));
+    EXPECT_EQ(Batch.DColumns[0].Value(2), "3");
+    EXPECT_EQ(Batch.DColumns[1].Value(1), "ca");
+    EXPECT_EQ(Batch.DColumns[2].Value(2), "open");
+
+    // codes carry over between batches, missing values are interned as ""
+    EXPECT_EQ(Reader.ReadRows(Batch, 3), (size_t)2);
+    EXPECT_EQ(Batch.DColumns[1].DCodes, std::vector<std::uint32_t>({2, 1}));
+    EXPECT_EQ(Reader.Dictionary(1), std::vector<std::string>({"us", "ca", ""}));
+    EXPECT_EQ(Reader.Dictionary(2), std::vector<std::string>({"open", "closed", "", "op\"en"}));
+    EXPECT_EQ(Batch.DColumns[2].Value(1), "op\"en");
+    EXPECT_TRUE(Reader.Dictionary(0).empty());
+}
+
+TEST(DSVReader, EncodeProjectedColumns){
+    auto Source = std::make_shared<CStringDataSource>("x,a,1\ny,b,2\nz,a,3\n");
+    CDSVReader Reader(Source, ',');
+    Reader.SelectColumns({2, 1});
+    Reader.EncodeColumns({1});
+    SDSVColumnBatch Batch;
+    EXPECT_EQ(Reader.ReadRows(Batch, 10), (size_t)3);
+    EXPECT_EQ(Batch.DColumns[0].Value(2), "3");
+    EXPECT_EQ(Batch.DColumns[1].DCodes, std::vector<std::uint32_t>({0, 1, 0}));
+    EXPECT_EQ(Reader.Dictionary(1), std::vector<std::string>({"a", "b"}));
+}
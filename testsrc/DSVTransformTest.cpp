@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "DSVTransform.h"
+#include "StringDataSink.h"
+#include "StringDataSource.h"
+
+using namespace DSVTransform;
+
+TEST(DSVTransform, ParseDelimiter){
+    char Delimiter = 0;
+    EXPECT_TRUE(ParseDelimiter("|", Delimiter));
+    EXPECT_EQ(Delimiter, '|');
+    EXPECT_TRUE(ParseDelimiter("tab", Delimiter));
+    EXPECT_EQ(Delimiter, '\t');
+    EXPECT_TRUE(ParseDelimiter("\\t", Delimiter));
+    EXPECT_EQ(Delimiter, '\t');
+    EXPECT_FALSE(ParseDelimiter("\"", Delimiter));
+    EXPECT_FALSE(ParseDelimiter("\n", Delimiter));
+    EXPECT_FALSE(ParseDelimiter("", Delimiter));
+    EXPECT_FALSE(ParseDelimiter(",,", Delimiter));
+}
+
+TEST(DSVTransform, ParseFilter){
+    SFilter Filter;
+    EXPECT_TRUE(ParseFilter("a=b", Filter));
+    EXPECT_EQ(Filter.DColumnName, "a");
+    EXPECT_EQ(Filter.DOp, EFilterOp::Equal);
+    EXPECT_EQ(Filter.DValue, "b");
+    EXPECT_TRUE(ParseFilter("a!=b", Filter));
+    EXPECT_EQ(Filter.DColumnName, "a");
+    EXPECT_EQ(Filter.DOp, EFilterOp::NotEqual);
+    EXPECT_EQ(Filter.DValue, "b");
+    EXPECT_TRUE(ParseFilter("name~x=y", Filter));
+    EXPECT_EQ(Filter.DColumnName, "name");
+    EXPECT_EQ(Filter.DOp, EFilterOp::Contains);
+    EXPECT_EQ(Filter.DValue, "x=y");
+    // the first operator splits, later ones belong to the value
+    EXPECT_TRUE(ParseFilter("a==", Filter));
+    EXPECT_EQ(Filter.DOp, EFilterOp::Equal);
+    EXPECT_EQ(Filter.DValue, "=");
+    EXPECT_TRUE(ParseFilter("a=", Filter));
+    EXPECT_EQ(Filter.DValue, "");
+
+    EXPECT_FALSE(ParseFilter("=x", Filter));
+    EXPECT_FALSE(ParseFilter("!=x", Filter));
+    EXPECT_FALSE(ParseFilter("~x", Filter));
+    EXPECT_FALSE(ParseFilter("abc", Filter));
+    EXPECT_FALSE(ParseFilter("", Filter));
+}
+
+TEST(DSVTransform, ResolveColumn){
+    TRow Header = {"id", "2", "name"};
+    std::size_t Column = 99;
+    EXPECT_TRUE(ResolveColumn("name", Header, Column));
+    EXPECT_EQ(Column, (size_t)2);
+    // a header name that looks like a number wins over the index
+    EXPECT_TRUE(ResolveColumn("2", Header, Column));
+    EXPECT_EQ(Column, (size_t)1);
+    EXPECT_TRUE(ResolveColumn("0", Header, Column));
+    EXPECT_EQ(Column, (size_t)0);
+    EXPECT_TRUE(ResolveColumn("7", Header, Column));
+    EXPECT_EQ(Column, (size_t)7);
+    EXPECT_FALSE(ResolveColumn("missing", Header, Column));
+    EXPECT_FALSE(ResolveColumn("1x", Header, Column));
+    EXPECT_FALSE(ResolveColumn("-1", Header, Column));
+    EXPECT_FALSE(ResolveColumn("", Header, Column));
+    EXPECT_TRUE(ResolveColumn("1", TRow(), Column));
+    EXPECT_EQ(Column, (size_t)1);
+}
+
+TEST(DSVTransform, Matches){
+    SFilter Filter;
+    ASSERT_TRUE(ParseFilter("1=b", Filter));
+    Filter.DColumn = 1;
+    EXPECT_TRUE(Filter.Matches({"a", "b"}));
+    EXPECT_FALSE(Filter.Matches({"a", "bb"}));
+    // missing columns compare as empty
+    EXPECT_FALSE(Filter.Matches({"a"}));
+    ASSERT_TRUE(ParseFilter("1!=b", Filter));
+    EXPECT_TRUE(Filter.Matches({"a"}));
+    EXPECT_FALSE(Filter.Matches({"a", "b"}));
+    ASSERT_TRUE(ParseFilter("1~ell", Filter));
+    EXPECT_TRUE(Filter.Matches({"", "hello"}));
+    EXPECT_FALSE(Filter.Matches({"hello", "x"}));
+    ASSERT_TRUE(ParseFilter("1=", Filter));
+    EXPECT_TRUE(Filter.Matches({"a"}));
+    EXPECT_TRUE(Filter.Matches({"a", ""}));
+}
+
+TEST(DSVTransform, Project){
+    TRow Row = {"a", "b", "c"};
+    TRow Out = {"stale", "stale", "stale", "stale", "stale"};
+    Project(Row, {2, 0, 0, 5}, Out);
+    EXPECT_EQ(Out, TRow({"c", "a", "a", ""}));
+
+    // a short row fills the missing columns with empty fields
+    TRow Short = {"x"};
+    Project(Short, {1, 0, 3}, Out);
+    EXPECT_EQ(Out, TRow({"", "x", ""}));
+
+    TRow Empty;
+    Project(Empty, {0, 1}, Out);
+    EXPECT_EQ(Out, TRow({"", ""}));
+}
+
+TEST(DSVTransform, StartHeader){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVReader Reader(std::make_shared<CStringDataSource>("id,name,country\n1,a,us\n"), ',');
+    CDSVWriter Writer(Sink, ',');
+    std::vector<std::size_t> Columns;
+    std::vector<SFilter> Filters(1);
+    Filters[0].DColumnName = "country";
+    std::string Unknown;
+    EXPECT_TRUE(StartHeader(Reader, Writer, true, {"name", "0"}, Columns, Filters, Unknown));
+    EXPECT_EQ(Columns, std::vector<std::size_t>({1, 0}));
+    EXPECT_EQ(Filters[0].DColumn, (std::size_t)2);
+    EXPECT_EQ(Sink->String(), "name,id\n");
+
+    EXPECT_FALSE(StartHeader(Reader, Writer, true, {"nope"}, Columns, Filters, Unknown));
+    EXPECT_EQ(Unknown, "nope");
+}
+
+TEST(DSVTransform, StartHeaderEmptyInput){
+    // no header row, so nothing is written and only indices resolve
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVReader Reader(std::make_shared<CStringDataSource>(""), ',');
+    CDSVWriter Writer(Sink, ',');
+    std::vector<std::size_t> Columns;
+    std::vector<SFilter> Filters;
+    std::string Unknown;
+    EXPECT_TRUE(StartHeader(Reader, Writer, true, {"1"}, Columns, Filters, Unknown));
+    EXPECT_EQ(Columns, std::vector<std::size_t>({1}));
+    EXPECT_EQ(Sink->String(), "");
+
+    EXPECT_FALSE(StartHeader(Reader, Writer, true, {"name"}, Columns, Filters, Unknown));
+    EXPECT_EQ(Unknown, "name");
+    EXPECT_EQ(Sink->String(), "");
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "FileDataSource.h"
+#include "FileDataSink.h"
+#include "DSVReader.h"
+#include "DSVWriter.h"
+#include "XMLWriter.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+
+static std::string TempFilename(const std::string &name){
+    return testing::TempDir() + "filedatatest_" + name;
+}
+
+static void WriteFile(const std::string &filename, const std::string &contents){
+    std::ofstream Output(filename, std::ios::binary);
+    Output << contents;
+}
+
+static std::string ReadFile(const std::string &filename){
+    std::ifstream Input(filename, std::ios::binary);
+    std::stringstream Contents;
+    Contents << Input.rdbuf();
+    return Contents.str();
+}
+
+TEST(FileDataSource, MissingFileTest){
+    CFileDataSource Source(TempFilename("doesnotexist.txt"));
+    char TempCh = 'x';
+
+    EXPECT_FALSE(Source.IsOpen());
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'x');
+}
+
+TEST(FileDataSource, GetPeekReadTest){
+    std::string Filename = TempFilename("getpeekread.txt");
+    WriteFile(Filename, "Hello World");
+    // small buffer so reads cross refills
+    CFileDataSource Source(Filename, 4);
+    std::vector< char > TempVector;
+    char TempCh = 'x';
+
+    ASSERT_TRUE(Source.IsOpen());
+    EXPECT_FALSE(Source.End());
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'H');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'H');
+    EXPECT_TRUE(Source.Read(TempVector,6));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"ello W");
+    EXPECT_EQ(Source.Consume(2),2);
+    EXPECT_TRUE(Source.Read(TempVector,100));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"ld");
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Read(TempVector,1));
+    std::remove(Filename.c_str());
+}
+
+TEST(FileDataSource, SeekTest){
+    std::string Filename = TempFilename("seek.txt");
+    WriteFile(Filename, "Hello World");
+    CFileDataSource Source(Filename, 4);
+    char TempCh = 'x';
+
+    ASSERT_TRUE(Source.IsOpen());
+    EXPECT_TRUE(Source.Seek(6));
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'W');
+    // past the end fails without moving, the end itself is fine
+    EXPECT_FALSE(Source.Seek(12));
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'o');
+    EXPECT_TRUE(Source.Seek(11));
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_TRUE(Source.End());
+    EXPECT_TRUE(Source.Seek(0));
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'H');
+    std::remove(Filename.c_str());
+
+    int Pipe[2];
+    ASSERT_EQ(pipe(Pipe),0);
+    CFileDataSource PipeSource(Pipe[0]);
+    EXPECT_FALSE(PipeSource.Seek(0));
+    close(Pipe[0]);
+    close(Pipe[1]);
+}
+
+TEST(FileDataSource, PipeTest){
+    int Pipe[2];
+    ASSERT_EQ(pipe(Pipe),0);
+    std::string Input = "a,b\n\"c\nd\",e\n";
+    ASSERT_EQ(write(Pipe[1], Input.data(), Input.size()), (ssize_t)Input.size());
+    close(Pipe[1]);
+
+    auto Source = std::make_shared<CFileDataSource>(Pipe[0], 3);
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"a","b"}));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"c\nd","e"}));
+    EXPECT_TRUE(Reader.End());
+    close(Pipe[0]);
+}
+
+TEST(FileDataSink, WriteFlushTest){
+    std::string Filename = TempFilename("writeflush.txt");
+    CFileDataSink Sink(Filename, 8);
+
+    ASSERT_TRUE(Sink.IsOpen());
+    EXPECT_TRUE(Sink.Put('H'));
+    EXPECT_TRUE(Sink.Write(std::string_view("ello")));
+    EXPECT_EQ(ReadFile(Filename),"");
+    EXPECT_TRUE(Sink.Write(std::vector<char>({' ','W','o','r','l','d'})));
+    EXPECT_EQ(ReadFile(Filename),"Hello");
+    EXPECT_TRUE(Sink.Write(std::string_view(" and a long tail")));
+    EXPECT_TRUE(Sink.Flush());
+    EXPECT_EQ(ReadFile(Filename),"Hello World and a long tail");
+    std::remove(Filename.c_str());
+}
+
+TEST(FileDataSink, DestructorFlushTest){
+    std::string Filename = TempFilename("destructorflush.txt");
+    {
+        auto Sink = std::make_shared<CFileDataSink>(Filename);
+        CDSVWriter Writer(Sink, ',');
+        Writer.WriteRow({"a","b,c"});
+    }
+    EXPECT_EQ(ReadFile(Filename),"a,\"b,c\"\n");
+    std::remove(Filename.c_str());
+}
+
+TEST(FileDataSink, XMLWriterTest){
+    int Pipe[2];
+    ASSERT_EQ(pipe(Pipe),0);
+    {
+        auto Sink = std::make_shared<CFileDataSink>(Pipe[1]);
+        CXMLWriter Writer(Sink);
+        SXMLEntity Entity;
+        Entity.DType = SXMLEntity::EType::CompleteElement;
+        Entity.DNameData = "item";
+        ASSERT_TRUE(Writer.WriteEntity(Entity));
+    }
+    close(Pipe[1]);
+
+    CFileDataSource Source(Pipe[0]);
+    std::vector<char> TempVector;
+    EXPECT_TRUE(Source.Read(TempVector,100));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"<item/>");
+    close(Pipe[0]);
+}
+
+TEST(FileDataSink, ClosedDescriptorTest){
+    CFileDataSink Sink(-1);
+
+    EXPECT_FALSE(Sink.IsOpen());
+    EXPECT_TRUE(Sink.Put('x'));
+    EXPECT_FALSE(Sink.Flush());
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "GzipDataSource.h"
+#include "GzipDataSink.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include "DSVReader.h"
+#include "DSVWriter.h"
+#include "XMLReader.h"
+
+static std::string Compress(const std::string &str){
+    auto Sink = std::make_shared<CStringDataSink>();
+    {
+        CGzipDataSink Compressor(Sink);
+        Compressor.Write(std::string_view(str));
+    }
+    return Sink->String();
+}
+
+static std::string Decompress(const std::string &str, std::size_t bufsize = CGzipDataSource::DefaultBufferSize){
+    CGzipDataSource Source(std::make_shared<CStringDataSource>(str), bufsize);
+    std::vector<char> TempVector;
+    std::string Result;
+    while(Source.Read(TempVector, 7)){
+        Result.append(TempVector.begin(), TempVector.end());
+    }
+    EXPECT_FALSE(Source.Error());
+    return Result;
+}
+
+TEST(GzipDataSink, HeaderTest){
+    std::string Compressed = Compress("Hello World");
+
+    ASSERT_TRUE(Compressed.size() > 2);
+    EXPECT_EQ((unsigned char)Compressed[0], 0x1f);
+    EXPECT_EQ((unsigned char)Compressed[1], 0x8b);
+}
+
+TEST(GzipDataSink, FinishTest){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CGzipDataSink Compressor(Sink);
+
+    EXPECT_TRUE(Compressor.Put('H'));
+    EXPECT_TRUE(Compressor.Write(std::vector<char>({'i','!'})));
+    EXPECT_TRUE(Compressor.Flush());
+    // flushed data decodes even though the stream isn't finished yet
+    CGzipDataSource Partial(std::make_shared<CStringDataSource>(Sink->String()));
+    std::vector<char> TempVector;
+    EXPECT_TRUE(Partial.Read(TempVector, 10));
+    EXPECT_EQ(std::string(TempVector.begin(), TempVector.end()), "Hi!");
+    EXPECT_TRUE(Partial.Error());
+    EXPECT_TRUE(Compressor.Finish());
+    EXPECT_FALSE(Compressor.Put('x'));
+    EXPECT_EQ(Decompress(Sink->String()), "Hi!");
+}
+
+TEST(GzipDataSink, SlicedWriteTest){
+    std::string Input;
+    for(int Index = 0; Index < 1000; Index++){
+        Input += std::to_string(Index) + ",";
+    }
+    auto Sink = std::make_shared<CStringDataSink>();
+    {
+        // writes bigger than the staging buffer go straight to deflate, here
+        // in 7 byte slices as if they were over 4GiB
+        CGzipDataSink Compressor(Sink, Z_DEFAULT_COMPRESSION, 16, 7);
+        EXPECT_TRUE(Compressor.Write(std::string_view(Input)));
+        EXPECT_TRUE(Compressor.Write(std::string_view(Input)));
+        EXPECT_TRUE(Compressor.Finish());
+    }
+    EXPECT_EQ(Decompress(Sink->String()), Input + Input);
+}
+
+TEST(GzipDataSource, RoundTripTest){
+    std::string Input;
+    for(int Index = 0; Index < 20000; Index++){
+        Input += std::to_string(Index * 7919) + ",";
+    }
+
+    EXPECT_EQ(Decompress(Compress(Input)), Input);
+    EXPECT_EQ(Decompress(Compress(Input), 5), Input);
+    EXPECT_EQ(Decompress(Compress("")), "");
+}
+
+TEST(GzipDataSource, ConcatenatedMembersTest){
+    EXPECT_EQ(Decompress(Compress("Hello ") + Compress("World")), "Hello World");
+}
+
+TEST(GzipDataSource, CorruptInputTest){
+    std::string Compressed = Compress("Hello World");
+    CGzipDataSource Truncated(std::make_shared<CStringDataSource>(Compressed.substr(0, Compressed.size() / 2)));
+    CGzipDataSource Garbage(std::make_shared<CStringDataSource>("not compressed at all"));
+    std::vector<char> TempVector;
+
+    Truncated.Read(TempVector, 100);
+    EXPECT_TRUE(Truncated.End());
+    EXPECT_TRUE(Truncated.Error());
+    EXPECT_FALSE(Garbage.Read(TempVector, 100));
+    EXPECT_TRUE(Garbage.End());
+    EXPECT_TRUE(Garbage.Error());
+}
+
+TEST(GzipDataSource, DSVRoundTripTest){
+    auto Sink = std::make_shared<CStringDataSink>();
+    {
+        CDSVWriter Writer(std::make_shared<CGzipDataSink>(Sink), ',');
+        Writer.WriteRow({"a","b,c"});
+        Writer.WriteRow({"d\ne","f"});
+    }
+
+    auto Source = std::make_shared<CGzipDataSource>(std::make_shared<CStringDataSource>(Sink->String()));
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"a","b,c"}));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"d\ne","f"}));
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(GzipDataSource, XMLReaderTest){
+    auto Source = std::make_shared<CGzipDataSource>(std::make_shared<CStringDataSource>(Compress("<root><child>hi</child></root>")));
+    CXMLReader Reader(Source);
+    SXMLEntity Entity;
+
+    ASSERT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DNameData, "root");
+    ASSERT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DNameData, "child");
+    ASSERT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DNameData, "hi");
+}
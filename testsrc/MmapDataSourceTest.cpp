@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "MmapDataSource.h"
+#include "DSVReader.h"
+
+#include <cstdio>
+#include <string>
+
+static std::string WriteTempFile(const std::string &contents){
+    std::string Filename = testing::TempDir() + "mmapsourcetest_" + std::to_string(contents.size()) + ".txt";
+    FILE *File = fopen(Filename.c_str(), "wb");
+    fwrite(contents.data(), 1, contents.size(), File);
+    fclose(File);
+    return Filename;
+}
+
+TEST(MmapDataSource, MissingFileTest){
+    CMmapDataSource Source(testing::TempDir() + "mmapsourcetest_doesnotexist.txt");
+    char TempCh = 'x';
+
+    EXPECT_FALSE(Source.IsOpen());
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'x');
+}
+
+TEST(MmapDataSource, EmptyFileTest){
+    std::string Filename = WriteTempFile("");
+    CMmapDataSource Source(Filename);
+    std::vector< char > TempVector;
+
+    EXPECT_TRUE(Source.IsOpen());
+    EXPECT_TRUE(Source.End());
+    EXPECT_EQ(Source.Size(),0);
+    EXPECT_FALSE(Source.Read(TempVector,3));
+    std::remove(Filename.c_str());
+}
+
+TEST(MmapDataSource, GetPeekReadTest){
+    std::string Filename = WriteTempFile("Hello World");
+    CMmapDataSource Source(Filename);
+    std::vector< char > TempVector;
+    char TempCh = 'x';
+
+    ASSERT_TRUE(Source.IsOpen());
+    EXPECT_EQ(Source.Size(),11);
+    EXPECT_EQ(std::string(Source.Data(),Source.Size()),"Hello World");
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'H');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'H');
+    EXPECT_EQ(Source.Position(),1);
+    EXPECT_TRUE(Source.Read(TempVector,4));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"ello");
+    EXPECT_TRUE(Source.Read(TempVector,100));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end())," World");
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Peek(TempCh));
+    std::remove(Filename.c_str());
+}
+
+TEST(MmapDataSource, DSVReaderTest){
+    std::string Filename = WriteTempFile("a,b\n\"c,d\",e\n");
+    auto Source = std::make_shared<CMmapDataSource>(Filename);
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"a","b"}));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"c,d","e"}));
+    EXPECT_TRUE(Reader.End());
+    std::remove(Filename.c_str());
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "PrefetchDataSource.h"
+#include "StringDataSource.h"
+#include "DSVReader.h"
+
+TEST(PrefetchDataSource, EmptyTest){
+    CPrefetchDataSource Source(std::make_shared<CStringDataSource>(""));
+    std::vector< char > TempVector;
+    char TempCh = 'x';
+
+    EXPECT_EQ(Source.BufferSize(),CPrefetchDataSource::DefaultBufferSize);
+    EXPECT_EQ(Source.QueueDepth(),CPrefetchDataSource::DefaultQueueDepth);
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'x');
+    EXPECT_FALSE(Source.Read(TempVector,3));
+}
+
+TEST(PrefetchDataSource, GetPeekReadTest){
+    CPrefetchDataSource Source(std::make_shared<CStringDataSource>("Hello World"), 3, 2);
+    std::vector< char > TempVector;
+    const char *Data = nullptr;
+    std::size_t Length = 0;
+    char TempCh = 'x';
+
+    EXPECT_EQ(Source.BufferSize(),3);
+    EXPECT_EQ(Source.QueueDepth(),2);
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'H');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'H');
+    EXPECT_TRUE(Source.Window(Data,Length));
+    EXPECT_EQ(std::string(Data,Length),"el");
+    EXPECT_TRUE(Source.Read(TempVector,5));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"ello ");
+    EXPECT_EQ(Source.Consume(2),2);
+    EXPECT_TRUE(Source.Read(TempVector,100));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"rld");
+    EXPECT_TRUE(Source.End());
+}
+
+TEST(PrefetchDataSource, LargeInputTest){
+    std::string Input;
+    for(int Index = 0; Index < 50000; Index++){
+        Input += std::to_string(Index) + ',';
+    }
+    CPrefetchDataSource Source(std::make_shared<CStringDataSource>(Input), 1000, 3);
+    std::vector< char > TempVector;
+    std::string Result;
+
+    while(Source.Read(TempVector,777)){
+        Result.append(TempVector.begin(),TempVector.end());
+    }
+    EXPECT_EQ(Result,Input);
+}
+
+TEST(PrefetchDataSource, EarlyDestroyTest){
+    // prefetch thread is blocked on a full ring when the source goes away
+    CPrefetchDataSource Source(std::make_shared<CStringDataSource>(std::string(10000,'x')), 10, 2);
+    char TempCh;
+
+    EXPECT_TRUE(Source.Get(TempCh));
+}
+
+TEST(PrefetchDataSource, DSVReaderTest){
+    auto Source = std::make_shared<CPrefetchDataSource>(std::make_shared<CStringDataSource>("a,b\n\"c\nd\",e\n"), 2, 2);
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"a","b"}));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"c\nd","e"}));
+    EXPECT_TRUE(Reader.End());
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "SPSCQueue.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <time.h>
+
+static double ThreadCPUSeconds(){
+    timespec Time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Time);
+    return Time.tv_sec + Time.tv_nsec / 1e9;
+}
+
+TEST(SPSCQueue, FillAndDrain){
+    CSPSCQueue<std::string> Queue(3);
+    EXPECT_EQ(Queue.Capacity(), (size_t)4);
+    std::string Item;
+    EXPECT_FALSE(Queue.TryPop(Item));
+    for(int Index = 0; Index < 4; Index++){
+        Item = std::to_string(Index);
+        EXPECT_TRUE(Queue.TryPush(Item));
+    }
+    Item = "full";
+    EXPECT_FALSE(Queue.TryPush(Item));
+    EXPECT_EQ(Item, "full");
+    for(int Index = 0; Index < 4; Index++){
+        EXPECT_TRUE(Queue.TryPop(Item));
+        EXPECT_EQ(Item, std::to_string(Index));
+    }
+    EXPECT_FALSE(Queue.TryPop(Item));
+}
+
+TEST(SPSCQueue, MoveOnlyItems){
+    CSPSCQueue<std::unique_ptr<int>> Queue(2);
+    Queue.Push(std::make_unique<int>(7));
+    std::unique_ptr<int> Item;
+    Queue.Pop(Item);
+    ASSERT_TRUE(Item);
+    EXPECT_EQ(*Item, 7);
+}
+
+TEST(SPSCQueue, TwoThreads){
+    // a tiny queue so both sides keep wrapping and waiting on each other
+    CSPSCQueue<size_t> Queue(2);
+    const size_t Count = 100000;
+    std::thread Producer([&]{
+        for(size_t Index = 1; Index <= Count; Index++){
+            Queue.Push(Index);
+        }
+    });
+    size_t Sum = 0, Last = 0, Item;
+    for(size_t Index = 0; Index < Count; Index++){
+        Queue.Pop(Item);
+        EXPECT_EQ(Item, Last + 1);
+        Last = Item;
+        Sum += Item;
+    }
+    Producer.join();
+    EXPECT_EQ(Sum, Count * (Count + 1) / 2);
+}
+
+TEST(SPSCQueue, IdleWaitSleeps){
+    // both sides block for a while, neither should burn the CPU meanwhile
+    CSPSCQueue<int> Queue(1);
+    double ConsumerCPU = 0.0;
+    std::thread Consumer([&]{
+        double Start = ThreadCPUSeconds();
+        int Item;
+        Queue.Pop(Item);
+        ConsumerCPU = ThreadCPUSeconds() - Start;
+        EXPECT_EQ(Item, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        Queue.Pop(Item);
+        EXPECT_EQ(Item, 2);
+        Queue.Pop(Item);
+        EXPECT_EQ(Item, 3);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    Queue.Push(1);
+    Queue.Push(2);
+    double Start = ThreadCPUSeconds();
+    // full until the consumer wakes up
+    Queue.Push(3);
+    double ProducerCPU = ThreadCPUSeconds() - Start;
+    Consumer.join();
+    EXPECT_LT(ConsumerCPU, 0.1);
+    EXPECT_LT(ProducerCPU, 0.1);
+}
@@ -30,3 +30,29 @@ TEST(StringDataSink, WriteTest){
     EXPECT_TRUE(Sink.Write(TempVector2));
     EXPECT_EQ(Sink.String(),"Hello World");   
 }
+
+TEST(StringDataSink, WriteRangeTest){
+    CStringDataSink Sink;
+    std::string_view View = "Hello World";
+
+    EXPECT_TRUE(Sink.Write(View.data(),5));
+    EXPECT_EQ(Sink.String(),"Hello");
+    EXPECT_TRUE(Sink.Write(View.substr(5)));
+    EXPECT_EQ(Sink.String(),"Hello World");
+    EXPECT_TRUE(Sink.Write(View.data(),0));
+    EXPECT_EQ(Sink.String(),"Hello World");
+}
+
+TEST(StringDataSink, ReserveTakeTest){
+    CStringDataSink Sink;
+
+    Sink.Reserve(64);
+    EXPECT_TRUE(Sink.String().capacity() >= 64);
+    EXPECT_TRUE(Sink.Write(std::string_view("Hello")));
+    EXPECT_EQ(Sink.Take(),"Hello");
+    EXPECT_TRUE(Sink.String().empty());
+    EXPECT_TRUE(Sink.Put('W'));
+    EXPECT_EQ(Sink.String(),"W");
+    EXPECT_EQ(Sink.Take(),"W");
+    EXPECT_EQ(Sink.Take(),"");
+}
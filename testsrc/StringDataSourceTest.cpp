@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "StringDataSource.h"
+#include "CharOnlyDataSource.h"
 
 TEST(StringDataSource, EndTest){
     CStringDataSource EmptySource("");
@@ -81,3 +82,87 @@ TEST(StringDataSource, ReadTest){
     EXPECT_FALSE(Source2.Peek(TempCh));
     EXPECT_EQ(TempCh,'x');
 }
+
+TEST(StringDataSource, WindowTest){
+    CStringDataSource EmptySource("");
+    CStringDataSource Source("Hello");
+    const char *Data = nullptr;
+    std::size_t Length = 0;
+    char TempCh = 'x';
+
+    EXPECT_FALSE(EmptySource.Window(Data,Length));
+    EXPECT_EQ(Length,0);
+    EXPECT_TRUE(Source.Window(Data,Length));
+    EXPECT_EQ(std::string(Data,Length),"Hello");
+    EXPECT_EQ(Source.Consume(2),2);
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'l');
+    EXPECT_TRUE(Source.Window(Data,Length));
+    EXPECT_EQ(std::string(Data,Length),"llo");
+    EXPECT_EQ(Source.Consume(10),3);
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Window(Data,Length));
+}
+
+TEST(StringDataSource, DefaultWindowTest){
+    std::string Input(CDataSource::DefaultWindowSize + 5, 'a');
+    Input.back() = 'z';
+    CCharOnlyDataSource Source(Input);
+    const char *Data = nullptr;
+    std::size_t Length = 0;
+
+    // the default window is a whole block read, not a single byte
+    EXPECT_TRUE(Source.Window(Data,Length));
+    EXPECT_EQ(Length,CDataSource::DefaultWindowSize);
+    EXPECT_EQ(Source.Consume(3),3);
+    EXPECT_TRUE(Source.Window(Data,Length));
+    EXPECT_EQ(Length,CDataSource::DefaultWindowSize - 3);
+    // consuming past the buffered block reads on through the source
+    EXPECT_EQ(Source.Consume(Length + 2),Length + 2);
+    EXPECT_TRUE(Source.Window(Data,Length));
+    EXPECT_EQ(std::string(Data,Length),"aaz");
+    EXPECT_EQ(Source.Consume(10),3);
+    EXPECT_FALSE(Source.Window(Data,Length));
+}
+
+TEST(StringDataSource, MoveTest){
+    std::string Input = "Moved string that is too long for small string storage";
+    const char *Storage = Input.data();
+    CStringDataSource Source(std::move(Input));
+    const char *Data = nullptr;
+    std::size_t Length = 0;
+
+    EXPECT_TRUE(Source.Window(Data,Length));
+    EXPECT_EQ(Data,Storage);
+    EXPECT_EQ(std::string(Data,Length),"Moved string that is too long for small string storage");
+}
+
+TEST(StringDataSource, BorrowTest){
+    std::string Input = "Hello";
+    CStringDataSource Source{std::string_view(Input)};
+    const char *Data = nullptr;
+    std::size_t Length = 0;
+    std::vector< char > TempVector;
+
+    EXPECT_TRUE(Source.Window(Data,Length));
+    EXPECT_EQ(Data,Input.data());
+    EXPECT_TRUE(Source.Read(TempVector,3));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"Hel");
+    // borrowed, so changes to the caller's buffer show through
+    Input[3] = 'p';
+    EXPECT_TRUE(Source.Read(TempVector,3));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"po");
+    EXPECT_TRUE(Source.End());
+}
+
+TEST(StringDataSource, CopyTest){
+    CStringDataSource Source("Hello");
+    char TempCh = 'x';
+
+    EXPECT_TRUE(Source.Get(TempCh));
+    CStringDataSource Copy(Source);
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'e');
+    EXPECT_TRUE(Copy.Get(TempCh));
+    EXPECT_EQ(TempCh,'e');
+}
@@ -4,6 +4,82 @@
 #include "XMLWriter.h"
 #include "StringDataSource.h"
 #include "StringDataSink.h"
+#include "CharOnlyDataSource.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+// counts every allocation made through operator new in this binary; every
+// form is replaced so news and deletes always come from the same allocator
+static std::size_t AllocationCount = 0;
+
+static void *CountedAlloc(std::size_t size) {
+    AllocationCount++;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+static void *CountedAlignedAlloc(std::size_t size, std::align_val_t align) {
+    AllocationCount++;
+    std::size_t alignment = static_cast<std::size_t>(align);
+    // aligned_alloc wants a multiple of the alignment
+    std::size_t rounded = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+    if (void *ptr = std::aligned_alloc(alignment, rounded)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size) {
+    return CountedAlloc(size);
+}
+
+void *operator new[](std::size_t size) {
+    return CountedAlloc(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    return CountedAlignedAlloc(size, align);
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+    return CountedAlignedAlloc(size, align);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
 
 TEST(XMLReader, BasicReadEntities) {
     auto src = std::make_shared<CStringDataSource>(
@@ -122,3 +198,319 @@ TEST(XMLWriter, FlushClosesOpenTags) {
 
     EXPECT_EQ(sink->String(), "<root><child></child></root>");
 }
+
+TEST(XMLReader, LargeDocument) {
+    std::string doc = "<root>";
+    for (int i = 0; i < 1000; i++) {
+        doc += "<item id=\"" + std::to_string(i) + "\">text</item>";
+    }
+    doc += "</root>";
+    auto src = std::make_shared<CStringDataSource>(doc);
+    CXMLReader reader(src);
+
+    SXMLEntity e;
+    int items = 0;
+    while (reader.ReadEntity(e, true)) {
+        if (e.DType == SXMLEntity::EType::StartElement && e.DNameData == "item") {
+            EXPECT_EQ(e.AttributeValue("id"), std::to_string(items));
+            items++;
+        }
+    }
+    EXPECT_EQ(items, 1000);
+    EXPECT_TRUE(reader.End());
+}
+
+TEST(XMLReader, RecycledEntities) {
+    // hundreds of entities per parsed chunk make the queue grow and wrap
+    std::string doc = "<root>";
+    for (int i = 0; i < 500; i++) {
+        doc += i % 2 ? "<a x=\"1\" y=\"2\" z=\"3\"/>" : "<b>t" + std::to_string(i) + "</b>";
+    }
+    doc += "</root>";
+    auto src = std::make_shared<CStringDataSource>(doc);
+    CXMLReader reader(src);
+
+    SXMLEntity e;
+    // stale contents of the caller's entity must never leak through
+    e.DNameData = "stale";
+    e.SetAttribute("old", "value");
+    ASSERT_TRUE(reader.ReadEntity(e));
+    EXPECT_EQ(e.DNameData, "root");
+    EXPECT_TRUE(e.DAttributes.empty());
+    for (int i = 0; i < 500; i++) {
+        ASSERT_TRUE(reader.ReadEntity(e));
+        if (i % 2) {
+            EXPECT_EQ(e.DType, SXMLEntity::EType::CompleteElement);
+            EXPECT_EQ(e.DNameData, "a");
+            ASSERT_EQ(e.DAttributes.size(), 3u);
+            EXPECT_EQ(e.AttributeValue("z"), "3");
+            continue;
+        }
+        EXPECT_EQ(e.DType, SXMLEntity::EType::StartElement);
+        EXPECT_EQ(e.DNameData, "b");
+        EXPECT_TRUE(e.DAttributes.empty());
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DType, SXMLEntity::EType::CharData);
+        EXPECT_EQ(e.DNameData, "t" + std::to_string(i));
+        EXPECT_TRUE(e.DAttributes.empty());
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DType, SXMLEntity::EType::EndElement);
+        EXPECT_EQ(e.DNameData, "b");
+    }
+    ASSERT_TRUE(reader.ReadEntity(e));
+    EXPECT_EQ(e.DNameData, "root");
+    EXPECT_FALSE(reader.ReadEntity(e));
+    EXPECT_TRUE(reader.End());
+}
+
+TEST(XMLReader, RecycledAttributes) {
+    // attribute counts keep changing and values are too long for the small
+    // string buffer, so dropped pairs would show up as allocations
+    std::string value(40, 'v');
+    std::string doc = "<root>";
+    for (int i = 0; i < 20000; i++) {
+        switch (i % 4) {
+            case 0: doc += "<a x=\"" + value + "\" y=\"" + value + "\"/>"; break;
+            case 1: doc += "<b x=\"" + value + "\"/>"; break;
+            case 2: doc += "<c x=\"" + value + "\" y=\"" + value + "\" z=\"" + value + "\">t</c>"; break;
+            default: doc += "<d/>"; break;
+        }
+    }
+    doc += "</root>";
+    CXMLReader reader(std::make_shared<CStringDataSource>(doc), 4096, 64);
+
+    SXMLEntity e;
+    std::size_t count = 0;
+    std::size_t allocations = 0;
+    while (reader.ReadEntity(e)) {
+        // the first few thousand entities warm up the queue and the pools
+        if (++count == 4000) {
+            allocations = AllocationCount;
+        }
+        if (e.DNameData == "c" && e.DType == SXMLEntity::EType::StartElement) {
+            ASSERT_EQ(e.DAttributes.size(), 3u);
+            EXPECT_EQ(e.DAttributes[2].second, value);
+        }
+    }
+    EXPECT_EQ(AllocationCount, allocations);
+    EXPECT_EQ(count, 30002u);
+}
+
+static std::vector<SXMLEntity> ReadAll(CXMLReader &reader) {
+    std::vector<SXMLEntity> entities;
+    SXMLEntity e;
+    while (reader.ReadEntity(e)) {
+        entities.push_back(e);
+    }
+    EXPECT_TRUE(reader.End());
+    return entities;
+}
+
+TEST(XMLReader, ChunkSizes) {
+    std::string doc = "<root>";
+    for (int i = 0; i < 200; i++) {
+        doc += "<item id=\"" + std::to_string(i) + "\">caf\xC3\xA9 &amp; " + std::to_string(i) + "</item><empty/>";
+    }
+    doc += "</root>";
+    CXMLReader reference(std::make_shared<CStringDataSource>(doc));
+    std::vector<SXMLEntity> expected = ReadAll(reference);
+    ASSERT_EQ(expected.size(), 802u);
+    EXPECT_EQ(expected[2].DNameData, "caf\xC3\xA9 & 0");
+
+    for (std::size_t chunk : {1, 7, 100, 1 << 20}) {
+        CXMLReader reader(std::make_shared<CStringDataSource>(doc), chunk);
+        std::vector<SXMLEntity> entities = ReadAll(reader);
+        ASSERT_EQ(entities.size(), expected.size());
+        for (std::size_t i = 0; i < entities.size(); i++) {
+            EXPECT_EQ(entities[i].DType, expected[i].DType);
+            EXPECT_EQ(entities[i].DNameData, expected[i].DNameData);
+            EXPECT_EQ(entities[i].DAttributes, expected[i].DAttributes);
+        }
+    }
+
+    // sources without their own windows are read through the default one
+    CXMLReader charonly(std::make_shared<CCharOnlyDataSource>(doc), 4096);
+    EXPECT_EQ(ReadAll(charonly).size(), expected.size());
+}
+
+// Like a pipe with only part of the input written so far: real one byte
+// windows up to DAvailable, asking for more would block
+class CTrickleDataSource : public CDataSource {
+    private:
+        std::string DData;
+        std::size_t DPosition = 0;
+    public:
+        std::size_t DAvailable;
+        bool DBlocked = false;
+        CTrickleDataSource(const std::string &str, std::size_t available) : DData(str), DAvailable(available) {}
+        bool End() const noexcept override { return DPosition >= DData.size(); }
+        bool Get(char &ch) noexcept override { return Peek(ch) && (DPosition++, true); }
+        bool Peek(char &ch) noexcept override {
+            if (DPosition >= DData.size()) {
+                return false;
+            }
+            ch = DData[DPosition];
+            return true;
+        }
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override {
+            buf.clear();
+            char ch;
+            while (buf.size() < count && Get(ch)) {
+                buf.push_back(ch);
+            }
+            return !buf.empty();
+        }
+        bool Window(const char *&data, std::size_t &length) noexcept override {
+            if (DPosition >= DAvailable) {
+                DBlocked = true;
+                return false;
+            }
+            data = DData.data() + DPosition;
+            length = 1;
+            return true;
+        }
+        std::size_t Consume(std::size_t count) noexcept override {
+            DPosition += count;
+            return count;
+        }
+};
+
+TEST(XMLReader, OneByteWindows) {
+    // the reader doesn't ask for another window, which could block, once it
+    // has something to parse
+    auto source = std::make_shared<CTrickleDataSource>("<root><a/></root>", 12);
+    CXMLReader reader(source, 4096);
+    SXMLEntity entity;
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DNameData, "root");
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DType, SXMLEntity::EType::CompleteElement);
+    EXPECT_EQ(entity.DNameData, "a");
+    EXPECT_FALSE(source->DBlocked);
+
+    source->DAvailable = 17;
+    EXPECT_EQ(ReadAll(reader).size(), 1u);
+}
+
+TEST(XMLReader, QueueLimit) {
+    // far more entities than the limit fit in one chunk
+    std::string doc = "<root>";
+    for (int i = 0; i < 300; i++) {
+        doc += "<a n=\"" + std::to_string(i) + "\"/><b><c>x</c></b>";
+    }
+    doc += "</root>";
+    CXMLReader reference(std::make_shared<CStringDataSource>(doc), 1 << 20, 1 << 20);
+    std::vector<SXMLEntity> expected = ReadAll(reference);
+    ASSERT_EQ(expected.size(), 1802u);
+    EXPECT_EQ(expected[1].DType, SXMLEntity::EType::CompleteElement);
+
+    for (std::size_t limit : {1, 2, 5}) {
+        CXMLReader reader(std::make_shared<CStringDataSource>(doc), 1 << 20, limit);
+        SXMLEntity e;
+        // the whole input is consumed at once but parsing is only suspended
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_FALSE(reader.End());
+        std::vector<SXMLEntity> entities = ReadAll(reader);
+        entities.insert(entities.begin(), e);
+        ASSERT_EQ(entities.size(), expected.size());
+        for (std::size_t i = 0; i < entities.size(); i++) {
+            EXPECT_EQ(entities[i].DType, expected[i].DType);
+            EXPECT_EQ(entities[i].DNameData, expected[i].DNameData);
+            EXPECT_EQ(entities[i].DAttributes, expected[i].DAttributes);
+        }
+    }
+}
+
+TEST(XMLReader, CharDataLimit) {
+    // 2, 3 and 4 byte characters mixed with ASCII so cuts land mid-sequence
+    std::string text;
+    for (int i = 0; i < 2000; i++) {
+        text += i % 4 ? "a\xC3\xA9" "b\xE2\x82\xAC" : "\xF0\x9F\x98\x80";
+    }
+    std::string doc = "<root><data>" + text + "</data><small>hi</small></root>";
+
+    for (std::size_t limit : {1, 2, 5, 64, 1000}) {
+        CXMLReader reader(std::make_shared<CStringDataSource>(doc), 512, 4);
+        reader.SetCharDataLimit(limit);
+        SXMLEntity e;
+        ASSERT_TRUE(reader.ReadEntity(e));
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DNameData, "data");
+
+        std::string joined;
+        std::size_t pieces = 0;
+        while (reader.ReadEntity(e) && e.DType == SXMLEntity::EType::CharData) {
+            EXPECT_LE(e.DNameData.size(), std::max<std::size_t>(limit, 4));
+            // every piece starts on a character boundary
+            EXPECT_NE(static_cast<unsigned char>(e.DNameData[0]) & 0xC0, 0x80);
+            joined += e.DNameData;
+            pieces++;
+        }
+        EXPECT_EQ(joined, text);
+        EXPECT_GE(pieces, text.size() / std::max<std::size_t>(limit, 4));
+        EXPECT_EQ(e.DType, SXMLEntity::EType::EndElement);
+
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DNameData, "small");
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DNameData, limit < 2 ? "h" : "hi");
+    }
+
+    // skipped pieces never reach the caller
+    CXMLReader reader(std::make_shared<CStringDataSource>(doc));
+    reader.SetCharDataLimit(10);
+    SXMLEntity e;
+    std::size_t count = 0;
+    while (reader.ReadEntity(e, true)) {
+        EXPECT_NE(e.DType, SXMLEntity::EType::CharData);
+        count++;
+    }
+    EXPECT_EQ(count, 6u);
+}
+
+TEST(XMLReader, SkipElement) {
+    std::string doc = "<root><skip a=\"1\"><x><y>text</y><z/></x>";
+    for (int i = 0; i < 500; i++) {
+        doc += "<item>" + std::to_string(i) + "</item>";
+    }
+    doc += "more</skip><keep b=\"2\">kept</keep><empty/></root>";
+
+    // whole subtree queued already, and subtree still inside expat
+    for (std::size_t chunk : {std::size_t(1 << 20), std::size_t(7)}) {
+        CXMLReader reader(std::make_shared<CStringDataSource>(doc), chunk, 1);
+        SXMLEntity e;
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DNameData, "root");
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DNameData, "skip");
+        EXPECT_TRUE(reader.SkipElement());
+
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DType, SXMLEntity::EType::StartElement);
+        EXPECT_EQ(e.DNameData, "keep");
+        EXPECT_EQ(e.AttributeValue("b"), "2");
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DType, SXMLEntity::EType::CharData);
+        EXPECT_EQ(e.DNameData, "kept");
+        // only straight after a StartElement
+        EXPECT_FALSE(reader.SkipElement());
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DType, SXMLEntity::EType::EndElement);
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DType, SXMLEntity::EType::CompleteElement);
+        EXPECT_FALSE(reader.SkipElement());
+        ASSERT_TRUE(reader.ReadEntity(e));
+        EXPECT_EQ(e.DType, SXMLEntity::EType::EndElement);
+        EXPECT_EQ(e.DNameData, "root");
+        EXPECT_FALSE(reader.ReadEntity(e));
+        EXPECT_TRUE(reader.End());
+    }
+
+    // the skipped element never ends
+    CXMLReader truncated(std::make_shared<CStringDataSource>("<root><skip><x>abc</x>"), 4);
+    SXMLEntity e;
+    ASSERT_TRUE(truncated.ReadEntity(e));
+    ASSERT_TRUE(truncated.ReadEntity(e));
+    EXPECT_FALSE(truncated.SkipElement());
+    EXPECT_FALSE(truncated.ReadEntity(e));
+}